@@ -0,0 +1,128 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Shape string tokenizer microbenchmark: the old stringstream based splitString against fieldList.
+ * Only built when LC2KICAD_BUILD_BENCHMARKS is on. Usage: tokenizerbench [iterations]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "includes.hpp"
+
+#ifdef USE_WINAPI_FOR_TEXT_COLOR
+  #include <windows.h>
+#endif
+
+namespace lc2kicad
+{
+  // logger.cpp wants these from main.cpp
+  programArgumentParseResult argParseResult;
+#ifdef USE_WINAPI_FOR_TEXT_COLOR
+  HANDLE hStdOut;
+  CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
+  WORD wBackgroundColor;
+#endif
+}
+
+using namespace lc2kicad;
+using std::string;
+
+static const char *sampleShapes[] =
+{
+  "TRACK~1~1~GND~3985 3012 4010.5 3012 4010.5 3050 4100 3050~gge1234~0",
+  "PAD~RECT~4005.5~2998~6~5.9055~1~VCC~1~0~4002.5 2995.0472 4008.5 2995.0472 4008.5 3000.9528 4002.5 3000.9528~0~gge42~0~~Y~0~0~0.4~4005.5,2998",
+  "VIA~4050~3020~2.4~GND~0.6~gge77~0",
+  "TEXT~L~4000~3000~0.8~0~0~3~~6~R1~M 4000 3000 L 4003 2994~~gge7~",
+  "CIRCLE~4000~3000~10~1~3~gge8~0~~",
+};
+
+// Read through a volatile every time, so the optimizer can't hoist the work out of the loop
+static volatile char shapeDelimiter = '~';
+
+template<typename Work> double timeIt(const char *name, unsigned iterations, Work work)
+{
+  auto start = std::chrono::steady_clock::now();
+  size_t checksum = 0;
+  for(unsigned i = 0; i < iterations; i++)
+    for(auto &shape : sampleShapes)
+      checksum += work(shape, shapeDelimiter);
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+              / (double(iterations) * (sizeof(sampleShapes) / sizeof(sampleShapes[0])));
+  std::cout << name << ": " << ns << " ns/shape (checksum " << checksum << ")" << std::endl;
+  return ns;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned iterations = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 200000;
+
+  // Both sides touch every field, like the element parsers do
+  double before = timeIt("splitString", iterations, [](const char *shape, char delimiter)
+  {
+    stringlist fields = splitString(shape, delimiter);
+    size_t ret = 0;
+    for(auto &i : fields)
+      ret += i.size();
+    return ret;
+  });
+  double after = timeIt("fieldList  ", iterations, [](const char *shape, char delimiter)
+  {
+    fieldList fields(shape, delimiter);
+    size_t ret = 0;
+    for(size_t i = 0; i < fields.size(); i++)
+      ret += fields[i].size();
+    return ret;
+  });
+
+  std::cout << "Speedup: " << before / after << "x" << std::endl;
+
+  // A footprint sized LIB~ string, split into its shapes and then into fields
+  string footprint = "LIB~4000~3000~package`R0603`~0~~gge1~1~0123456789abcdef~0";
+  while(footprint.size() < 32768)
+    for(auto &shape : sampleShapes)
+      footprint += string("#@$") + shape;
+  unsigned footprintIterations = iterations / 100 + 1;
+
+  auto footprintStart = std::chrono::steady_clock::now();
+  size_t footprintChecksum = 0;
+  for(unsigned i = 0; i < footprintIterations; i++)
+    for(auto &shape : splitByString(footprint, string("#@$")))
+      footprintChecksum += splitString(shape, shapeDelimiter).size();
+  double footprintBefore = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - footprintStart).count();
+
+  footprintStart = std::chrono::steady_clock::now();
+  std::vector<fieldView> footprintShapes;
+  for(unsigned i = 0; i < footprintIterations; i++)
+  {
+    splitByString(footprint, "#@$", footprintShapes);
+    for(auto &shape : footprintShapes)
+      footprintChecksum -= fieldList(shape, shapeDelimiter).size();
+  }
+  double footprintAfter = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - footprintStart).count();
+
+  std::cout << footprint.size() << " byte LIB string, " << activeDelimiterScanner() << " scanner: "
+            << footprintBefore / footprintIterations << " us before, " << footprintAfter / footprintIterations
+            << " us after (checksum " << footprintChecksum << ")" << std::endl;
+  return 0;
+}
@@ -0,0 +1,62 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LC2KICAD_BEZIER_HPP_
+  #define LC2KICAD_BEZIER_HPP_
+
+  #include "includes.hpp"
+  #include "pointpool.hpp"
+  #include "smolsvg/svgpath.hpp"
+
+  namespace lc2kicad
+  {
+    /**
+     * Flattening of curves into chords that stay within a tolerance of the curve.
+     *
+     * The chord count of a curve is worked out from its control points before any point is made, from
+     * a bound of its second derivative, so it depends on how much the curve bends and not on how long it
+     * is. The points are then made by forward differencing (Béziers) or by rotating a unit vector
+     * (arcs), straight into arrays the caller has made room in. Each writes the chords - 1 points
+     * between the end points of its curve, in order; the end points themselves are up to the caller.
+     */
+
+    static const unsigned int maxCurveChords = 4096; // Upper bound of chords per curve whatever the tolerance
+
+    unsigned int quadraticBezierChords(const coordinates &p0, const coordinates &p1, const coordinates &p2,
+                                       double tolerance);
+    unsigned int cubicBezierChords(const coordinates &p0, const coordinates &p1, const coordinates &p2,
+                                   const coordinates &p3, double tolerance);
+    unsigned int ellipticalArcChords(const centerArc &arc, double tolerance);
+
+    void flattenQuadraticBezier(const coordinates &p0, const coordinates &p1, const coordinates &p2,
+                                unsigned int chords, double *x, double *y);
+    void flattenCubicBezier(const coordinates &p0, const coordinates &p1, const coordinates &p2,
+                            const coordinates &p3, unsigned int chords, double *x, double *y);
+    // arc is the result of svgEllipticalArcComputation for an arc of XAxisRotation degrees
+    void flattenEllipticalArc(const centerArc &arc, double XAxisRotation, unsigned int chords, double *x, double *y);
+
+    /**
+     * Append the outline of path to points: the start point of every segment, each followed by the
+     * points between its end points if it's a curve. Line segments come out as they are.
+     */
+    void flattenPath(const SmolSVG::pathBuffer &path, PointPool &points, double tolerance);
+  }
+
+#endif
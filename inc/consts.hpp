@@ -20,6 +20,7 @@
 #ifndef LC2KICAD_CONSTS
   #define LC2KICAD_CONSTS
 
+  #include <cstdint>
   #include <map>
   #include <string>
 
@@ -43,14 +44,13 @@
 
     static const char *documentTypeName[8] = {"", "schematics", "schematic library", "PCB", "PCB library", "project", "sub-part", "SPICE symbol"};
     static const char *documentExtensionName[8] = {"", "", ".lib", ".kicad_pcb", ".kicad_mod", "prj", "", ""};
-    //Layer mapper. Input EasyEDA, ouput KiCad.
-    static const int EasyEdaToKiCadLayerMap[] = {-1, 0, 31, 37, 36, 35, 34, 39, 38, -1, 44, -1, 41, 49, 48, -1, -1, -1, -1, -1, -1, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30};
     static const char *padTypeKiCad[] = {"smd", "smd", "thru_hole", "np_thru_hole"};
     static const char *padShapeKiCad[] = {"circle", "oval", "rect", "custom"};
 
     // Definiton from https://en.wikipedia.org/wiki/Filename#Reserved_characters_and_words .
     static const std::string illegalCharsOfFilenames = "\\/:%*?\"<>|,;=";
 
+    // Concrete kinds of EDAElement, stored in every element so it can be dispatched on without a virtual call.
     enum elementType
     {
       Base,
@@ -58,64 +58,95 @@
       PCBBase,
       PCBModule, PCBPad, PCBGraphicalTrack, PCBCopperTrack, PCBHole, PCBVia, PCBSolidRegion, PCBFloodFill,
       PCBGraphicalCircle, PCBCopperCircle, PCBRect, PCBGraphicalArc, PCBCopperArc,
+      PCBCopperSolidRegion, PCBKeepoutRegion, PCBText,
 
       SchBase,
-      SchModule, SchPin, SchPolyline, SchText, SchRect, SchPolygon, SchImage
+      SchModule, SchPin, SchPolyline, SchText, SchRect, SchPolygon, SchImage, SchArc
     };
 
-    static std::map<KiCadLayerIndex, std::string> KiCadLayerName
+    // KiCad layer names, flat and indexed by KiCadLayerIndex. Invalid maps to an empty name.
+    struct KiCadLayerNameTable
     {
-      {F_Cu, "F.Cu"},
-      {In1_Cu, "In1.Cu"},
-      {In2_Cu, "In2.Cu"},
-      {In3_Cu, "In3.Cu"},
-      {In4_Cu, "In4.Cu"},
-      {In5_Cu, "In5.Cu"},
-      {In6_Cu, "In6.Cu"},
-      {In7_Cu, "In7.Cu"},
-      {In8_Cu, "In8.Cu"},
-      {In9_Cu, "In9.Cu,"},
-      {In10_Cu, "In10.Cu"},
-      {In11_Cu, "In11.Cu"},
-      {In12_Cu, "In12.Cu"},
-      {In13_Cu, "In13.Cu"},
-      {In14_Cu, "In14.Cu"},
-      {In15_Cu, "In15.Cu"},
-      {In16_Cu, "In16.Cu"},
-      {In17_Cu, "In17.Cu"},
-      {In18_Cu, "In18.Cu"},
-      {In19_Cu, "In19.Cu"},
-      {In20_Cu, "In20.Cu"},
-      {In21_Cu, "In21.Cu"},
-      {In22_Cu, "In22.Cu"},
-      {In23_Cu, "In23.Cu"},
-      {In24_Cu, "In24.Cu"},
-      {In25_Cu, "In25.Cu"},
-      {In26_Cu, "In26.Cu"},
-      {In27_Cu, "In27.Cu"},
-      {In28_Cu, "In28.Cu"},
-      {In29_Cu, "In29.Cu"},
-      {In30_Cu, "In30.Cu"},
-      {B_Cu, "B.Cu"},
-      {B_Adhes, "B.Adhes"},
-      {F_Adhes, "F.Adhes"},
-      {B_Paste, "B.Paste"},
-      {F_Paste, "F.Paste"},
-      {B_SilkS, "B.SilkS"},
-      {F_SilkS, "F.SilkS"},
-      {B_Mask, "B.Mask"},
-      {F_Mask, "F.Mask"},
-      {Dwgs_User, "Dwgs.User"},
-      {Cmts_User, "Cmts.User"},
-      {Eco1_User, "Eco1.User"},
-      {Eco2_User, "Eco2.User"},
-      {Edge_Cuts, "Edge.Cuts"},
-      {Margin, "Margin"},
-      {B_CrtYd, "B.CrtYd"},
-      {F_CrtYd, "F.CrtYd"},
-      {B_Fab, "B.Fab"},
-      {F_Fab, "F.Fab"},
+      const char *names[F_Fab + 2];
+
+      constexpr const char* operator[](KiCadLayerIndex layer) const
+        { return layer >= Invalid && layer <= F_Fab ? names[layer + 1] : ""; }
+    };
+
+    static constexpr KiCadLayerNameTable KiCadLayerName
+    {
+      {
+        "", "F.Cu", "In1.Cu", "In2.Cu", "In3.Cu", "In4.Cu", "In5.Cu", "In6.Cu", "In7.Cu", "In8.Cu", "In9.Cu,",
+        "In10.Cu", "In11.Cu", "In12.Cu", "In13.Cu", "In14.Cu", "In15.Cu", "In16.Cu", "In17.Cu", "In18.Cu", "In19.Cu",
+        "In20.Cu", "In21.Cu", "In22.Cu", "In23.Cu", "In24.Cu", "In25.Cu", "In26.Cu", "In27.Cu", "In28.Cu", "In29.Cu",
+        "In30.Cu", "B.Cu", "B.Adhes", "F.Adhes", "B.Paste", "F.Paste", "B.SilkS", "F.SilkS", "B.Mask", "F.Mask",
+        "Dwgs.User", "Cmts.User", "Eco1.User", "Eco2.User", "Edge.Cuts", "Margin", "B.CrtYd", "F.CrtYd", "B.Fab",
+        "F.Fab"
+      }
     };
+    static_assert(KiCadLayerName[Invalid][0] == '\0' && KiCadLayerName[B_Cu][0] == 'B' && KiCadLayerName[F_Fab][2] == 'F',
+                  "KiCadLayerName must have one entry per KiCadLayerIndex");
+
+    /**
+     * Layer mapper. Input EasyEDA layer ID, output KiCad layer. Dense, so a lookup is one bounds check
+     * and one load; IDs that KiCad has no counterpart for, or that EasyEDA doesn't use, give Invalid.
+     *
+     * isCopper() answers from a bitmask over the EasyEDA IDs, for parsers that only need to pick
+     * between the copper and graphical variant of an element.
+     */
+    struct EasyEdaLayerTable
+    {
+      static const int size = 102;
+      KiCadLayerIndex layers[size];
+      uint64_t copperMask;
+
+      constexpr KiCadLayerIndex operator[](int easyEdaLayer) const
+        { return easyEdaLayer >= 0 && easyEdaLayer < size ? layers[easyEdaLayer] : Invalid; }
+      constexpr bool isCopper(int easyEdaLayer) const
+        { return easyEdaLayer >= 0 && easyEdaLayer < 64 && (copperMask >> easyEdaLayer & 1); }
+    };
+
+    constexpr EasyEdaLayerTable makeEasyEdaLayerTable()
+    {
+      EasyEdaLayerTable table {};
+      for(int i = 0; i < EasyEdaLayerTable::size; i++)
+        table.layers[i] = Invalid;
+
+      table.layers[1] = F_Cu;
+      table.layers[2] = B_Cu;
+      table.layers[3] = F_SilkS;
+      table.layers[4] = B_SilkS;
+      table.layers[5] = F_Paste;
+      table.layers[6] = B_Paste;
+      table.layers[7] = F_Mask;
+      table.layers[8] = B_Mask;
+      table.layers[10] = Edge_Cuts;
+      // 11 is Multilayer, for through holes. No such layer for KiCad
+      table.layers[12] = Cmts_User;
+      table.layers[13] = F_Fab;
+      table.layers[14] = B_Fab;
+      table.layers[15] = Eco1_User; // Mechanical layer
+      // 16 to 20 are 3D model, component outline, pin outline, through hole (graphical only) and violation marker
+      for(int i = 21; i <= 50; i++) // Inner layers 1 to 30
+        table.layers[i] = static_cast<KiCadLayerIndex>(In1_Cu + (i - 21));
+      table.layers[99] = F_CrtYd; // Package Shape, equivalent to KiCad Courtyard but needs to take care of flipping
+      // 100 is Pin Shape, 101 is Component marking
+
+      for(int i = 0; i < 64; i++)
+        if(table.layers[i] >= F_Cu && table.layers[i] <= B_Cu)
+          table.copperMask |= uint64_t(1) << i;
+      return table;
+    }
+
+    static constexpr EasyEdaLayerTable EasyEdaToKiCadLayerMap = makeEasyEdaLayerTable();
+
+    static_assert(F_Cu == 0 && B_Cu == In30_Cu + 1, "Copper layers must be contiguous from F_Cu to B_Cu");
+    static_assert(EasyEdaToKiCadLayerMap[21] == In1_Cu && EasyEdaToKiCadLayerMap[50] == In30_Cu,
+                  "EasyEDA inner layers 21 to 50 must map onto In1_Cu to In30_Cu");
+    static_assert(EasyEdaToKiCadLayerMap[99] == F_CrtYd && EasyEdaToKiCadLayerMap[EasyEdaLayerTable::size] == Invalid,
+                  "EasyEDA layer table is out of shape");
+    static_assert(EasyEdaToKiCadLayerMap.copperMask == (uint64_t(0x3FFFFFFF) << 21 | 0x6),
+                  "Only EasyEDA layers 1, 2 and 21 to 50 are copper");
 
   }
 
@@ -0,0 +1,81 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LC2KICAD_CONVERSIONCACHE_HPP_
+  #define LC2KICAD_CONVERSIONCACHE_HPP_
+
+  #include <atomic>
+  #include <map>
+  #include <mutex>
+  #include <string>
+  #include <vector>
+
+  #include "includes.hpp"
+
+  namespace lc2kicad
+  {
+    /**
+     * Persistent on-disk cache of converted output, turned on with "-a CACHE:1" and placed with --cache-dir.
+     *
+     * An entry holds every file written for one input file, keyed by the SHA-256 of the converter version
+     * and output revision, the parser arguments, the base name of the input (output files are named after
+     * it) and its bytes.
+     * On a hit the files are written again as they were, without parsing anything.
+     *
+     * Several processes may share a directory: entries are written to a temporary file and renamed into
+     * place, so readers see either a whole entry or none, and anything that can't be read is a miss. Hits
+     * refresh the modification time of their entry, and trim() removes the least recently used entries
+     * once the directory grows past the size limit.
+     */
+    class ConversionCache
+    {
+      public:
+        struct outputFile
+        {
+          std::string name, content;
+        };
+
+        // Parser arguments go into every key; they're taken here, as cores fill in defaults while they work.
+        ConversionCache(const std::string &directory, unsigned long long sizeLimit, const str_dbl_map &parserArguments);
+
+        std::string makeKey(const std::string &inputName, const char *input, size_t length) const;
+        bool load(const std::string &key, std::vector<outputFile> &outputs);
+        void store(const std::string &key, const std::vector<outputFile> &outputs);
+        // Note that input writes path in this run. False if another input of the run wrote it already.
+        bool claimOutput(const std::string &path, const std::string &input);
+
+        void trim(); // Evict entries until the directory fits in the size limit
+        void reportStatistics() const;
+
+        static std::string defaultDirectory();
+
+      private:
+        std::string entryPath(const std::string &key) const;
+
+        std::string directory;
+        unsigned long long sizeLimit;
+        str_dbl_map parserArguments;
+        std::mutex outputWritersMutex;
+        std::map<std::string, std::string> outputWriters; // Output path -> the input that wrote it first this run
+        std::atomic<unsigned long> hits {0}, misses {0}, stores {0}, evictions {0}, temporaryCounter {0};
+    };
+  }
+
+#endif
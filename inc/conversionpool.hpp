@@ -0,0 +1,52 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LC2KICAD_CONVERSIONPOOL_HPP_
+  #define LC2KICAD_CONVERSIONPOOL_HPP_
+
+  #include <string>
+
+  #include "includes.hpp"
+
+  namespace lc2kicad
+  {
+    class ConversionCache;
+
+    /**
+     * Converts a list of input files on a fixed number of worker threads ("-j N").
+     *
+     * Every worker builds its own LC2KiCadCore, so no serializer or deserializer state is shared. A worker
+     * takes one file at a time and runs parse, serialize and write on it before taking the next, so at most
+     * one input's documents per worker are held in memory. With a conversion cache, workers share it.
+     */
+    class ConversionPool
+    {
+      public:
+        ConversionPool(const str_dbl_map &parserArguments, unsigned int workerCount, ConversionCache *cache = nullptr);
+
+        void convertFiles(const stringlist &filenames, std::string &outputPath);
+
+      private:
+        str_dbl_map coreParserArguments;
+        unsigned int workerCount;
+        ConversionCache *cache;
+    };
+  }
+
+#endif
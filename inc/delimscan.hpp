@@ -0,0 +1,49 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LC2KICAD_DELIMSCAN_HPP_
+  #define LC2KICAD_DELIMSCAN_HPP_
+
+  #include <cstddef>
+
+  namespace lc2kicad
+  {
+    /**
+     * Find the positions of delimiterA or delimiterB in [first, last), in order, writing at most
+     * capacity of them into found. Returns how many were written. Pass the same character twice
+     * to look for a single delimiter.
+     *
+     * The scan is vectorized with AVX2 or SSE2 when the CPU supports it, selected once at runtime;
+     * other targets use a scalar loop.
+     */
+    size_t scanDelimiters(const char *first, const char *last, char delimiterA, char delimiterB,
+                          const char **found, size_t capacity);
+
+    // First occurrence of delimiter in [first, last), or last if there isn't one.
+    inline const char* findDelimiter(const char *first, const char *last, char delimiter)
+    {
+      const char *found;
+      return scanDelimiters(first, last, delimiter, delimiter, &found, 1) ? found : last;
+    }
+
+    // Name of the scanner implementation in use, for diagnostics.
+    const char* activeDelimiterScanner();
+  }
+
+#endif
@@ -25,10 +25,15 @@
   #include <string>
   #include <memory>
   #include <map>
+  #include <unordered_map>
 
   #include "includes.hpp"
   #include "consts.hpp"
   #include "rapidjson.hpp"
+  #include "inputbuffer.hpp"
+  #include "elementarena.hpp"
+  #include "pointpool.hpp"
+  #include "stringpool.hpp"
   
   using std::list;
   using std::vector;
@@ -54,18 +59,58 @@
   {
     class LC2KiCadCore;
     class KiCad_5_Deserializer;
+    class OutputBuffer;
 
-    typedef std::pair<unsigned int, string> PCBNet;
+    typedef unsigned int PCBNet; // Net code in the document's PCBNetManager
+    typedef arenaVector<coordinates> arenaCoordslist; // Point lists inside elements, stored in the document's arena
 
+    /**
+     * c_para key/value pairs of a module. Both sides are interned in the owning document's string pool,
+     * so lookups compare handles; a module only has a dozen or so pairs, which a flat list handles fine.
+     */
+    class cparaMap
+    {
+      public:
+        void set(internedString key, internedString value)
+        {
+          for(auto &i : entries)
+            if(i.first == key)
+            {
+              i.second = value;
+              return;
+            }
+          entries.emplace_back(key, value);
+        }
+
+        internedString operator[](internedString key) const // Empty if the key isn't present
+        {
+          for(auto &i : entries)
+            if(i.first == key)
+              return i.second;
+          return internedString();
+        }
+
+      private:
+        arenaVector<std::pair<internedString, internedString>> entries;
+    };
+
+    /**
+     * Interning table for net names. Codes are handed out in order of first appearance, starting with
+     * the unnamed net 0, and elements only keep the code.
+     */
     class PCBNetManager
     {
       private:
-        map<unsigned int, string> netNameCodeMap;
+        std::unordered_map<string, unsigned int> netCodeByName; // Keyed by the name as read from the file
+        vector<string> netNames; // Indexed by code, escaped for output
+        vector<const string*> rawNetNames; // Indexed by code, pointing at the keys above
       public:
-        unsigned int obtainNetCode(string &netName); // Get netcode if present, or else would create new one.
-        void setNet(string& netName, PCBNet &net);
-        bool findNet(string &netName); // Return true if a net is present, vice-versa.
-        string outputPCBNetInfo(); // For deserializer calls.
+        unsigned int obtainNetCode(const string &netName); // Get netcode if present, or else would create new one.
+        void setNet(const string& netName, PCBNet &net);
+        PCBNet importNet(const PCBNetManager &other, PCBNet net); // Code here for a net of another document
+        bool findNet(const string &netName) const; // Return true if a net is present, vice-versa.
+        const string& netName(PCBNet net) const { return netNames[net]; }
+        void outputPCBNetInfo(OutputBuffer&) const; // For deserializer calls.
         PCBNetManager();
     };
 
@@ -85,6 +130,7 @@
         unsigned int maximumPriority = 0; //< The greatest EasyEDA fill order number
       public:
         void logPriority(unsigned int); //< Use this when you need to add a fill to the beloging document
+        void merge(const PCBFloodFillPriorityManager&); //< Take over the fills logged by another document
         unsigned int getKiCadPriority(unsigned int); //< Use this when obtaining KiCad priority on output
     };
 
@@ -99,22 +145,31 @@
 
     struct EDAElement;
     struct PCBElement;
+    struct PCB_GraphicalArc;
     //Referencing each other, must declare one first.
 
     struct EDADocument
     {
       string pathToFile;
       bool module; // When is true, means only convert the first element contained and output as a module.
+      shared_ptr<InputFileBuffer> inputBuffer; // In-situ parsed JSON strings live here. Must outlive jsonParseResult.
       shared_ptr<rapidjson::Document> jsonParseResult; // For convenience. This is only one pointer and isn't gonna take much RAM
+      rapidjson::Value *jsonObject = nullptr; // Borrowed view of the object this document is parsed from, inside
+                                              // jsonParseResult (e.g. one page of a project). Null means the whole DOM.
       str_str_map docInfo; // Due to compatibility concerns, use a map to store temporary info for use
 
       documentTypes docType;
       coordinates origin {0, 0};
       double gridSize;
 
+      StringPool stringPool; // Strings interned by the elements below. Declared first so it outlives them
+      ElementArena elementArena; // Every element below (nested ones too) lives here and goes away with the document
+      PointPool pointPool; // Points of the tracks and regions below
       std::vector<EDAElement*> containedElements;
 
       LC2KiCadCore *parent = nullptr;
+
+      rapidjson::Value& documentObject() { return jsonObject ? *jsonObject : *jsonParseResult; }
       
       virtual void addElement(EDAElement*);
       //virtual string* deserializeSelf(str_dbl_pair deserializerSwitch);
@@ -127,11 +182,17 @@
 
     struct PCBDocument : public EDADocument
     {
+      PCBDocument() : EDADocument(false) { }
       PCBDocument(const EDADocument&);
       void addElement(EDAElement*) override;
       PCBNetManager netManager;
       PCBFloodFillPriorityManager fillPriorityManager;
       vector<PCBNetClass> netClasses;
+      vector<std::unique_ptr<PCBDocument>> parseShards; // Own elements of this document parsed in parallel
+      svgArcBatch pendingArcs; // ARCs parsed but not resolved yet, and the element and origin of each
+      vector<std::pair<PCB_GraphicalArc*, coordinates>> pendingArcElements;
+      void resolveParsedShapes(); // Transform the point pool and resolve pending ARCs, once parsing is done
+      size_t polygonVerticesRead = 0, polygonVerticesKept = 0; // Of simplified flood fills and solid regions
       ~PCBDocument();
     };
     
@@ -147,11 +208,22 @@
       bool visibility = true, locked = false;
       string id;
 
-      virtual string* deserializeSelf(KiCad_5_Deserializer&) const = 0;
-      
+      elementType kind = Base; // Concrete type of this element, set by createElement(). Dispatch on this, not on RTTI.
+
       virtual ~EDAElement();
     };
 
+    /**
+     * Make a T in the document's element arena and tag it with T::typeTag. All elements must be created
+     * through this, or they can't be told apart when deserializing.
+     */
+    template <typename T> T* createElement(ElementArena &arena)
+    {
+      T *ret = arena.create<T>();
+      ret->kind = T::typeTag;
+      return ret;
+    }
+
     /**
      * This section is dedicated for elements on the PCBs and footprints.
      */
@@ -176,9 +248,9 @@
       bool topLayer; // TODO: DEPRECATE THIS.
       time_t updateTime;
       KiCadLayerIndex layer;
-      map<string, string> cparaContent;
+      cparaMap cparaContent;
       string reference, name, uuid;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBModule;
     };
 
     /**
@@ -193,10 +265,10 @@
       double orientation;
       coordinates padCoordinates;
       sizeXY padSize, holeSize;
-      string pinNumber;
+      internedString pinNumber;
       PCBNet net;
-      coordslist shapePolygonPoints;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      arenaCoordslist shapePolygonPoints;
+      static const elementType typeTag = PCBPad;
     };
 
     //TRACKs on non copper layers.
@@ -204,15 +276,15 @@
     {
       enum KiCadLayerIndex layerKiCad;
       double width;
-      coordslist trackPoints;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      pointRange trackPoints;
+      static const elementType typeTag = PCBGraphicalTrack;
     };
 
     //TRACKs on copper layers.
     struct PCB_CopperTrack : public PCB_GraphicalTrack
     {
       PCBNet net;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBCopperTrack;
     };
 
     //HOLEs (non-plated through-holes) in LCEDA.
@@ -220,7 +292,7 @@
     {
       coordinates holeCoordinates;
       double holeDiameter;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBHole;
     };
 
     /**
@@ -232,14 +304,14 @@
     {
       PCBNet net;
       double viaDiameter; //The outer diameter of the copper ring
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBVia;
     };
     
     struct PCB_GraphicalSolidRegion : public PCBElement
     {
-      coordslist fillAreaPolygonPoints;
+      pointRange fillAreaPolygonPoints;
       enum KiCadLayerIndex layerKiCad;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBSolidRegion;
     };
 
     /**
@@ -251,7 +323,7 @@
     {
       PCBNet net;
       enum KiCadLayerIndex layerKiCad;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBCopperSolidRegion;
     };
 
     /**
@@ -266,13 +338,13 @@
       bool isPreservingIslands, isSpokeConnection;
       int EasyEDAPriority;
       PCBNet net;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBFloodFill;
     };
 
     struct PCB_KeepoutRegion : public PCB_GraphicalSolidRegion
     {
       bool allowRouting, allowVias, allowFloodFill;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBKeepoutRegion;
     };
         
     //CIRCLEs on non copper layers.
@@ -281,14 +353,14 @@
       coordinates center;
       enum KiCadLayerIndex layerKiCad;
       double width, radius;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBGraphicalCircle;
     };
 
     //CIRCLEs on copper layers.
     struct PCB_CopperCircle : public PCB_GraphicalCircle
     {
       PCBNet net;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBCopperCircle;
     };
 
     /**
@@ -304,7 +376,7 @@
       sizeXY size;
       enum KiCadLayerIndex layerKiCad;
       double strokeWidth;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBRect;
     };
 
     //ARCs on non copper layers. Derived from PCB_Arc.
@@ -314,14 +386,14 @@
       //For default, use right direction as 0 deg point. Use degrees not radians.
       double angle, width;
       enum KiCadLayerIndex layerKiCad;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBGraphicalArc;
     };
 
     //ARCs on copper layers.
     struct PCB_CopperArc : public PCB_GraphicalArc
     {
       PCBNet net;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBCopperArc;
     };
 
     //TEXTs on PCBs.
@@ -333,7 +405,7 @@
       double height, orientation, width;
       enum PCBTextTypes type;
       enum KiCadLayerIndex layerKiCad;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = PCBText;
     };
 
     //PROTRACTORs.
@@ -355,14 +427,15 @@
       double orientation;
       int subpart = -1;
       string reference, value, uuid, name;
-      map<string, string> cparaContent;
+      cparaMap cparaContent;
       time_t updateTime;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = SchModule;
     };
     
     struct Schematic_Pin : public Schematic_Element
     {
-      string pinName, pinNumber;
+      string pinName;
+      internedString pinNumber;
       int pinLength;
       int fontSize; //Font size is a fixed-point number, divided by 10 before use
       bool inverted, clock; //In EasyEDA a pin has a property "Dot" which means "Inverted" in KiCad
@@ -373,15 +446,15 @@
        * EasyEDA use up and right as positive, while KiCad use down and left.
        */
       coordinates pinCoord;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = SchPin;
     };
     
     struct Schematic_Polyline : public Schematic_Element
     {
-      vector<coordinates> polylinePoints;
+      arenaCoordslist polylinePoints;
       bool isFilled; //Fill color is not supported, but if EasyEDA document has a non-white fill color, then fill it
       int lineWidth;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = SchPolyline;
     };
     
     //struct SchematicArc : public SchematicElement
@@ -392,7 +465,7 @@
       int fontSize; //Font size is a fixed-point number, divide by 10 before use
       bool italic, bold;
       coordinates position; //Text coordinate defined as the bottom left corner (when 0 deg rotation)
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = SchText;
     };
     
     //Schematic rectangle. KiCad doesn't support round corner rectangles.
@@ -402,12 +475,12 @@
       sizeXY size;
       int width;
       bool isFilled;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = SchRect;
     };
     
     struct Schematic_Polygon : public Schematic_Polyline
     {
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = SchPolygon;
     };
 
     struct Schematic_Arc : public Schematic_Element
@@ -418,7 +491,7 @@
       int width;
       bool isFilled,
            elliptical; // KiCad doesn't support elliptical arcs, those would require linearization
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = SchArc;
     };
     
     struct Schematic_Image : public Schematic_Element
@@ -426,6 +499,6 @@
       coordinates position;
       string content;
       bool isBase64Image;
-      string* deserializeSelf(KiCad_5_Deserializer&) const;
+      static const elementType typeTag = SchImage;
     };
   }
@@ -0,0 +1,151 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LC2KICAD_ELEMENTARENA_HPP_
+  #define LC2KICAD_ELEMENTARENA_HPP_
+
+  #include <cstddef>
+  #include <new>
+  #include <type_traits>
+  #include <utility>
+  #include <vector>
+
+  namespace lc2kicad
+  {
+    /**
+     * Monotonic allocator for the element tree of one document. Elements and the point lists inside
+     * them are carved out of large blocks one after another and never freed on their own; the whole
+     * tree goes away in one step when the arena is released, which normally happens when the owning
+     * document is destroyed.
+     *
+     * Objects made with create() still get their destructors called on release (in reverse order),
+     * because elements hold strings and maps that own memory outside the arena. Nothing may delete
+     * them.
+     */
+    class ElementArena
+    {
+      public:
+        explicit ElementArena(size_t blockSize = 65536);
+        ~ElementArena();
+
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        // Construct a value-initialized T in the arena. Arena containers default-constructed as members of
+        // T during this call allocate from this arena as well.
+        template <typename T, typename... Args> T* create(Args&&... args)
+        {
+          destructorNode *node = nullptr;
+          if(!std::is_trivially_destructible<T>::value)
+            node = static_cast<destructorNode*>(allocate(sizeof(destructorNode), alignof(destructorNode)));
+          void *storage = allocate(sizeof(T), alignof(T));
+
+          ElementArena *outerArena = constructingArena;
+          constructingArena = this;
+          T *ret;
+          try { ret = new(storage) T(std::forward<Args>(args)...); }
+          catch(...) { constructingArena = outerArena; throw; }
+          constructingArena = outerArena;
+
+          if(node)
+          {
+            node->object = ret;
+            node->destroy = [](void *object) { static_cast<T*>(object)->~T(); };
+            node->next = destructors;
+            destructors = node;
+          }
+          return ret;
+        }
+
+        // Destroy everything made by create() and give all blocks back.
+        void release();
+
+        size_t bytesInUse() const { return inUse; }
+        size_t highWaterMark() const { return peak; } // Most bytes ever handed out between releases
+
+        // Arena whose create() is running on this thread, if any. Used by ArenaAllocator.
+        static ElementArena* constructing() { return constructingArena; }
+
+        ElementArena(const ElementArena&) = delete;
+        ElementArena& operator=(const ElementArena&) = delete;
+
+      private:
+        struct alignas(std::max_align_t) block // Payload follows the header, suitably aligned
+        {
+          block *next;
+        };
+        struct destructorNode
+        {
+          destructorNode *next;
+          void (*destroy)(void*);
+          void *object;
+        };
+
+        block *blocks = nullptr;
+        char *cursor = nullptr, *limit = nullptr;
+        destructorNode *destructors = nullptr;
+        size_t blockSize, inUse = 0, peak = 0;
+
+        static thread_local ElementArena *constructingArena;
+
+        block* newBlock(size_t payloadSize, bool makeCurrent);
+    };
+
+    /**
+     * Standard allocator on top of ElementArena. One that isn't bound to an arena uses the heap.
+     *
+     * A default-constructed allocator binds to the arena currently constructing an element (see
+     * ElementArena::create), so the point lists of an element follow it into its arena without every
+     * element type needing an allocator-aware constructor. Copies of such containers go back to the heap.
+     */
+    template <typename T> class ArenaAllocator
+    {
+      public:
+        typedef T value_type;
+
+        ArenaAllocator() : arena(ElementArena::constructing()) { }
+        explicit ArenaAllocator(ElementArena *arena) : arena(arena) { }
+        template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) { }
+
+        T* allocate(size_t n)
+        {
+          if(arena)
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+          return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        void deallocate(T *p, size_t)
+        {
+          if(!arena) // Arena memory is given back all at once
+            ::operator delete(p);
+        }
+
+        ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(nullptr); }
+
+        template <typename U> bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+        template <typename U> bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+
+      private:
+        template <typename U> friend class ArenaAllocator;
+        ElementArena *arena;
+    };
+
+    template <typename T> using arenaVector = std::vector<T, ArenaAllocator<T>>;
+  }
+
+#endif
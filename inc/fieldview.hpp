@@ -0,0 +1,171 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LC2KICAD_FIELDVIEW_HPP_
+  #define LC2KICAD_FIELDVIEW_HPP_
+
+  #include <string>
+  #include <cstring>
+  #include <stdexcept>
+
+  #include "delimscan.hpp"
+
+  namespace lc2kicad
+  {
+    /**
+     * A non-owning view of a piece of a string, used for the fields of EasyEDA shape strings.
+     * The viewed string must outlive the view. In LC2KiCad that's almost always the in-situ parsed
+     * JSON buffer held by the EDADocument being parsed.
+     *
+     * Indexing past the end yields '\0', which mimics what std::string::operator[] gives for the
+     * (very common) "first character of a possibly empty field" checks in the serializer.
+     */
+    class fieldView
+    {
+      public:
+        fieldView() : ptr(""), len(0) {}
+        fieldView(const char *_ptr, size_t _len) : ptr(_ptr), len(_len) {}
+        fieldView(const char *_cstr) : ptr(_cstr), len(std::strlen(_cstr)) {}
+        fieldView(const std::string &_str) : ptr(_str.data()), len(_str.size()) {}
+
+        const char* begin() const { return ptr; }
+        const char* end() const { return ptr + len; }
+        const char* data() const { return ptr; }
+        size_t size() const { return len; }
+        size_t length() const { return len; }
+        bool empty() const { return len == 0; }
+        char operator[](size_t i) const { return i < len ? ptr[i] : '\0'; }
+
+        std::string str() const { return std::string(ptr, len); }
+        fieldView substr(size_t pos, size_t n = std::string::npos) const
+        {
+          if(pos > len) pos = len;
+          return fieldView(ptr + pos, n > len - pos ? len - pos : n);
+        }
+        bool startsWith(const fieldView &o) const { return o.len <= len && !std::memcmp(ptr, o.ptr, o.len); }
+        bool endsWith(const fieldView &o) const { return o.len <= len && !std::memcmp(ptr + len - o.len, o.ptr, o.len); }
+
+        bool operator==(const fieldView &o) const { return len == o.len && !std::memcmp(ptr, o.ptr, len); }
+        bool operator!=(const fieldView &o) const { return !(*this == o); }
+        bool operator==(const char *o) const { return *this == fieldView(o); }
+        bool operator!=(const char *o) const { return !(*this == fieldView(o)); }
+
+      private:
+        const char *ptr;
+        size_t len;
+    };
+
+    inline std::string operator+(const std::string &a, const fieldView &b) { return std::string(a).append(b.data(), b.size()); }
+    inline std::string operator+(const char *a, const fieldView &b) { return std::string(a).append(b.data(), b.size()); }
+
+    /**
+     * Walks the fields of a string one by one, without storing them anywhere.
+     * Used for the unbounded lists in shape strings, like point coordinates in tracks and polygons.
+     *
+     * Follows std::getline splitting rules, so results match the old splitString: empty fields in the
+     * middle are kept, but a trailing empty field (string ending with a delimiter) is not produced.
+     */
+    class fieldTokenizer
+    {
+      public:
+        fieldTokenizer(const fieldView &source, char _delimiter)
+          : cursor(source.begin()), last(source.end()), delimiter(_delimiter) {}
+
+        bool next(fieldView &field)
+        {
+          if(cursor >= last)
+            return false;
+          const char *fieldEnd = findDelimiter(cursor, last, delimiter);
+          field = fieldView(cursor, fieldEnd - cursor);
+          cursor = fieldEnd + 1;
+          return true;
+        }
+
+      private:
+        const char *cursor, *last;
+        char delimiter;
+    };
+
+    /**
+     * Fixed capacity field index of a single shape string, e.g. "TRACK~1~1~GND~0 0 10 10~gge5~0".
+     * Every element parser reads its parameters through this instead of a vector of strings, so
+     * tokenizing a shape allocates nothing. Fields that don't exist read as empty views.
+     *
+     * An optional multi-character alternate delimiter is also accepted, for schematic pins which
+     * use "^^" between their sub-shapes.
+     *
+     * Strings with more than maxFields fields throw std::runtime_error (as assertThrow does; this header
+     * comes before it), rather than losing the fields that don't fit.
+     */
+    class fieldList
+    {
+      public:
+        static const size_t maxFields = 64;
+
+        fieldList() : count(0) {}
+        fieldList(const fieldView &source, char delimiter, const char *altDelimiter = nullptr) : count(0)
+        {
+          const char *found[maxFields];
+          const char *scanFrom = source.begin(), *last = source.end(), *fieldBegin = scanFrom;
+          size_t altLength = altDelimiter ? std::strlen(altDelimiter) : 0;
+
+          // Delimiter positions come from the vectorized scanner, a batch at a time. Candidates for
+          // the alternate delimiter are only its first character, so they're verified here.
+          while(count < maxFields)
+          {
+            size_t foundCount = scanDelimiters(scanFrom, last, delimiter, altLength ? *altDelimiter : delimiter,
+                                               found, maxFields);
+            for(size_t i = 0; i < foundCount && count < maxFields; i++)
+            {
+              size_t delimiterLength = 1;
+              if(found[i] < fieldBegin)
+                continue; // Inside an alternate delimiter that was already consumed
+              if(*found[i] != delimiter)
+              {
+                if(static_cast<size_t>(last - found[i]) < altLength || std::memcmp(found[i], altDelimiter, altLength))
+                  continue;
+                delimiterLength = altLength;
+              }
+              fields[count++] = fieldView(fieldBegin, found[i] - fieldBegin);
+              fieldBegin = found[i] + delimiterLength;
+            }
+            if(foundCount < maxFields)
+              break;
+            scanFrom = found[foundCount - 1] + 1;
+          }
+          if(fieldBegin < last)
+          {
+            if(count == maxFields)
+              throw std::runtime_error("More than " + std::to_string(maxFields) + " fields in \"" +
+                                       std::string(source.begin(), source.size() > 64 ? 64 : source.size()) +
+                                       (source.size() > 64 ? "...\"." : "\"."));
+            fields[count++] = fieldView(fieldBegin, last - fieldBegin);
+          }
+        }
+
+        fieldView operator[](size_t i) const { return i < count ? fields[i] : fieldView(); }
+        size_t size() const { return count; }
+
+      private:
+        fieldView fields[maxFields];
+        size_t count;
+    };
+  }
+
+#endif
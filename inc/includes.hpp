@@ -33,6 +33,8 @@
   #include <cmath>
   #include <functional>
 
+  #include "fieldview.hpp"
+
   namespace lc2kicad
   {
   /*
@@ -72,7 +74,7 @@
     {
       public:
         RAIIC()
-          { resource = new T; }
+          { resource = new T(); } // Value-initialized: parsers leave fields unset when the input lacks them
         RAIIC(T* ptr)
           { resource = ptr; }
         ~RAIIC()
@@ -142,6 +144,23 @@
       sizeXY size;
       double angleStart, angleExtend;
     };
+
+    /**
+     * Elliptical arcs in SVG's endpoint form, one array per field, to have their centers and angles worked
+     * out all at once by svgEllipticalArcComputation(). Results come out the same way, one array per field
+     * of centerArc.
+     */
+    struct svgArcBatch
+    {
+      std::vector<double> startX, startY, radiusX, radiusY, rotation, endX, endY;
+      std::vector<char> largeArc, sweep;
+      std::vector<double> centerX, centerY, sizeX, sizeY, angleStart, angleExtend; // Results
+
+      size_t add(double x0, double y0, double rx, double ry, double angle, bool largeArcFlag, bool sweepFlag,
+                 double x, double y);
+      size_t size() const { return startX.size(); }
+      void clear();
+    };
     
     enum documentTypes { invalid = 0, schematic = 1, schematic_lib = 2, pcb = 3, pcb_lib = 4, project = 5, sub_part = 6, spice_symbol = 7 };
 
@@ -154,8 +173,11 @@
            exportNestedLibs = false,
            verboseInfo = false,
            usePipe = false;
+      unsigned int jobCount = 1;
       std::string configFile,
-                  outputDirectory;
+                  outputDirectory,
+                  logFile,
+                  cacheDirectory;
       str_dbl_map parserArguments;
       stringlist filenames;
     };
@@ -165,22 +187,21 @@
     void assertThrow(const bool statement, const char* message);  
     void assertThrow(const bool statement, const std::string &message);
 
-    //int EasyEdaToKiCadLayerMap\[\];
-    std::string LCLayerToKiCadName(const int&);
-
     stringlist splitString(std::string sourceString, char delimeter);
     std::string base_name(const std::string& path);
     void sanitizeFileName(std::string &filename);
     std::string decToHex(const unsigned long long _decimal);
     void findAndReplaceString(std::string& subject, const std::string& search,const std::string& replace);
-    std::string loadNthSeparated(std::string &s, char delimiter, unsigned int nth);
-    int tolStoi(const std::string &, const int fail = 0);
-    double tolStod(const std::string &, const double fail = 0.0);
+    int tolStoi(const fieldView &, const int fail = 0);
+    double tolStod(const fieldView &, const double fail = 0.0);
     inline double toRadians(double degree) { return (degree / 180.0) * PI; }
     inline double toDegrees(double radian) { return (radian / PI) * 180.0; }
     bool fuzzyCompare(const double, const double);
     centerArc svgEllipticalArcComputation(double, double, double, double, double, bool, bool, double, double);
+    void svgEllipticalArcComputation(svgArcBatch &batch);
     std::vector<std::string> splitByString(const std::string&, std::string&&);
+    void splitByString(const fieldView&, const fieldView&, std::vector<fieldView>&);
+    bool splitFirstByString(const fieldView&, const fieldView&, fieldView &head, fieldView &rest);
     std::string escapeQuotedString(const std::string);
 
     void Error(std::string s);
@@ -0,0 +1,65 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LC2KICAD_INPUTBUFFER_HPP_
+  #define LC2KICAD_INPUTBUFFER_HPP_
+
+  #include <string>
+  #include <vector>
+  #include <memory>
+  #include <istream>
+
+  namespace lc2kicad
+  {
+    /**
+     * Raw bytes of an input document, kept alive for as long as any EDADocument refers to it.
+     *
+     * RapidJSON in-situ parsing makes every string in the DOM point right into this buffer, so
+     * the long EasyEDA "shape" strings are never copied into the Document allocator. The buffer
+     * is always null terminated and writable, because in-situ parsing terminates strings in place.
+     *
+     * Files are mapped copy-on-write whenever the mapping is guaranteed to be followed by a zero
+     * byte (i.e. the file doesn't end exactly on a page boundary). Otherwise, and for streams
+     * like stdin which can't be mapped, the content is read into an owned heap buffer instead.
+     */
+    class InputFileBuffer
+    {
+      public:
+        static std::shared_ptr<InputFileBuffer> mapFile(const std::string &path);
+        static std::shared_ptr<InputFileBuffer> readStream(std::istream &stream);
+
+        char* data() { return buffer; }
+        size_t size() const { return length; }
+        bool isMapped() const { return mapped; }
+
+        InputFileBuffer(const InputFileBuffer&) = delete;
+        InputFileBuffer& operator=(const InputFileBuffer&) = delete;
+        ~InputFileBuffer();
+
+      private:
+        InputFileBuffer() = default;
+
+        char *buffer = nullptr;
+        size_t length = 0;
+        bool mapped = false;
+        std::vector<char> ownedStorage; // Used when the content couldn't be mapped
+    };
+  }
+
+#endif
@@ -23,6 +23,7 @@
   #include <string>
   #include "includes.hpp"
   #include "edaclasses.hpp"
+  #include "outputbuffer.hpp"
 
   using namespace lc2kicad;
   
@@ -37,37 +38,39 @@
         
         virtual ~KiCad_5_Deserializer();
 
-        virtual std::string* outputFileHeader();
-        virtual std::string* outputFileEnding();
+        virtual void outputFileHeader(OutputBuffer&);
+        virtual void outputFileEnding(OutputBuffer&);
 
-        std::string* outputPCBNetclassRules(const vector<PCBNetClass>&);
+        void outputPCBNetclassRules(const vector<PCBNetClass>&, OutputBuffer&);
+
+        void outputElement(const EDAElement&, OutputBuffer&); // Calls the output method matching element.kind
   
-        std::string* outputPCBModule(const PCB_Module&);
-        std::string* outputPCBPad(const PCB_Pad&) const;
-        std::string* outputPCBVia(const PCB_Via&) const;
-        std::string* outputPCBGraphicalTrack(const PCB_GraphicalTrack&) const;
-        std::string* outputPCBCopperTrack(const PCB_CopperTrack&) const;
-        std::string* outputPCBHole(const PCB_Hole&) const;
-        std::string* outputPCBCopperSolidRegion(const PCB_CopperSolidRegion&) const;
-        std::string* outputPCBGraphicalSolidRegion(const PCB_GraphicalSolidRegion&) const;
-        std::string* outputPCBKeepoutRegion(const PCB_KeepoutRegion& target) const;
-        std::string* outputPCBFloodFill(const PCB_FloodFill&) const;
-        std::string* outputPCBGraphicalCircle(const PCB_GraphicalCircle&) const;
-        std::string* outputPCBCopperCircle(const PCB_CopperCircle&) const;
-        std::string* outputPCBGraphicalArc(const PCB_GraphicalArc&) const;
-        std::string* outputPCBCopperArc(const PCB_CopperArc&) const;
-        std::string* outputPCBRect(const PCB_Rect&) const;
-        std::string* outputPCBText(const PCB_Text&) const;
+        void outputPCBModule(const PCB_Module&, OutputBuffer&);
+        void outputPCBPad(const PCB_Pad&, OutputBuffer&) const;
+        void outputPCBVia(const PCB_Via&, OutputBuffer&) const;
+        void outputPCBGraphicalTrack(const PCB_GraphicalTrack&, OutputBuffer&) const;
+        void outputPCBCopperTrack(const PCB_CopperTrack&, OutputBuffer&) const;
+        void outputPCBHole(const PCB_Hole&, OutputBuffer&) const;
+        void outputPCBCopperSolidRegion(const PCB_CopperSolidRegion&, OutputBuffer&) const;
+        void outputPCBGraphicalSolidRegion(const PCB_GraphicalSolidRegion&, OutputBuffer&) const;
+        void outputPCBKeepoutRegion(const PCB_KeepoutRegion& target, OutputBuffer&) const;
+        void outputPCBFloodFill(const PCB_FloodFill&, OutputBuffer&) const;
+        void outputPCBGraphicalCircle(const PCB_GraphicalCircle&, OutputBuffer&) const;
+        void outputPCBCopperCircle(const PCB_CopperCircle&, OutputBuffer&) const;
+        void outputPCBGraphicalArc(const PCB_GraphicalArc&, OutputBuffer&) const;
+        void outputPCBCopperArc(const PCB_CopperArc&, OutputBuffer&) const;
+        void outputPCBRect(const PCB_Rect&, OutputBuffer&) const;
+        void outputPCBText(const PCB_Text&, OutputBuffer&) const;
         
-        std::string* outputSchModule(const Schematic_Module& target);
-        std::string* outputSchPin(const Schematic_Pin&) const;
-        std::string* outputSchPolyline(const Schematic_Polyline&) const;
-        std::string* outputSchText(const Schematic_Text&) const;
-        std::string* outputSchRect(const Schematic_Rect&) const;
-        std::string* outputSchPolygon(const Schematic_Polygon&) const;
-        std::string* outputSchArc(const Schematic_Arc&) const;
+        void outputSchModule(const Schematic_Module& target, OutputBuffer&);
+        void outputSchPin(const Schematic_Pin&, OutputBuffer&) const;
+        void outputSchPolyline(const Schematic_Polyline&, OutputBuffer&) const;
+        void outputSchText(const Schematic_Text&, OutputBuffer&) const;
+        void outputSchRect(const Schematic_Rect&, OutputBuffer&) const;
+        void outputSchPolygon(const Schematic_Polygon&, OutputBuffer&) const;
+        void outputSchArc(const Schematic_Arc&, OutputBuffer&) const;
         /*
-        std::string* outputSchImage(const Schematic_Image) const;
+        void outputSchImage(const Schematic_Image&, OutputBuffer&) const;
         */
 
       private:
@@ -75,6 +78,8 @@
         str_dbl_map internalCompatibilitySwitches; //3-Character version copy of compatibility switches.
         std::string indent;
         inline bool isProcessingModules() const { return workingDocument->module | processingModule; };
+        inline const std::string& netName(PCBNet net) const
+          { return static_cast<PCBDocument*>(workingDocument)->netManager.netName(net); }
         bool        processingModule, currentPackageOnTopLayer;
     };
   }
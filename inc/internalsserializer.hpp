@@ -21,20 +21,51 @@
   #define LC2KICAD_LCSTRINGPARSER
 
   #include <string>
+  #include <unordered_set>
   #include "includes.hpp"
   #include "rapidjson.hpp"
   #include "edaclasses.hpp"
+  #include "streamreader.hpp"
 
   using namespace lc2kicad;
 
   namespace lc2kicad
   {
+    /**
+     * Components already taken out during nested library extraction. Placements sharing a UUID are
+     * recognized from the header alone, before anything else of them gets parsed.
+     */
+    struct nestedLibraryCache
+    {
+      map<string, RAIIC<EDADocument>> documents; // UUID<->Component pair. Ordered, libraries come out by UUID
+
+      // Whether a component with this UUID was already taken out; says so in verbose mode if it was
+      bool isDuplicate(const fieldView &uuid, const fieldView &id) const;
+      // Record a new component. Its name gets the gID appended if another one is already called that.
+      void add(const fieldView &uuid, string &name, const string &id);
+
+      private:
+        std::unordered_set<string> uuids, names;
+    };
+
+    /**
+     * What PCB shapes are parsed against. It's passed down rather than kept in the serializer, so shapes
+     * and footprints can be parsed on several threads at once, each thread with contexts of its own.
+     */
+    struct pcbShapeContext
+    {
+      PCBDocument *owner; // Where elements, points and strings go, and nets and fill priorities are logged
+      coordinates origin; // Subtracted from every coordinate; a footprint's position while parsing its shapes
+      bool inModule;      // Shapes belong to a footprint
+    };
+
     class LCJSONSerializer
     {
       public:
         void setCompatibilitySwitches(const str_dbl_map&);
         void initWorkingDocument(EDADocument*);
         void deinitWorkingDocument();
+        void attachShapeStream(EasyEDAStreamReader*);
 
         virtual ~LCJSONSerializer();
         
@@ -44,112 +75,77 @@
         virtual list<EDADocument *> parseSchNestedLibs();
         virtual list<EDADocument *> parsePCBNestedLibs();
 
-        virtual void parseSchLibComponent(std::vector<std::string>&, vector<Schematic_Element*> &containedElements);
-        virtual void parsePCBLibComponent(std::vector<std::string>&, vector<EDAElement*> &containedElements);
+        virtual void parseSchLibComponent(std::vector<fieldView>&, vector<Schematic_Element*> &containedElements);
+        virtual void parsePCBLibComponent(const pcbShapeContext&, std::vector<fieldView>&,
+                                          vector<EDAElement*> &containedElements) const;
+        void parseSchShape(const fieldView&, vector<Schematic_Element*> &containedElements);
+        void parsePCBShape(const pcbShapeContext&, const fieldView&, vector<EDAElement*> &containedElements) const;
+        void parsePCBShapesParallel(const pcbShapeContext&, std::vector<fieldView> &shapesList,
+                                    vector<EDAElement*> &containedElements, unsigned int threadCount) const;
+        void forEachShape(rapidjson::Value &shapesArray, const std::function<void(const fieldView&)> &consumer);
 
         virtual void parsePCBDRCRules(rapidjson::Value &drcRules);
 
-        void parseCommonDoucmentStructure(rapidjson::Document &parseTarget,
-                                          std::vector<std::string> &canvasPropertyList,
+        void parseCommonDoucmentStructure(rapidjson::Value &parseTarget,
+                                          fieldList &canvasPropertyList,
                                           rapidjson::Value &shapesArray,
                                           rapidjson::Value &headObject);
 
-        PCB_Pad* parsePCBPadString(const std::string&);
-        PCB_Module* parsePCBDiscretePadString(const std::string&);
-        PCB_Hole* parsePCBHoleString(const std::string&);
-        PCB_Via* parsePCBViaString(const std::string&);
-        PCB_CopperTrack* parsePCBCopperTrackString(const std::string&);
-        PCB_GraphicalTrack* parsePCBGraphicalTrackString(const std::string&);
-        PCB_FloodFill* parsePCBFloodFillString(const std::string&);
-        PCB_GraphicalSolidRegion* parsePCBGraphicalSolidRegionString(const std::string&);
-        PCB_GraphicalTrack* parsePCBNpthRegionString(const std::string&);
-        PCB_FloodFill* parsePCBCopperSolidRegionString(const std::string&);
-        PCB_FloodFill* parsePCBPlaneZoneString(const std::string&);
-        PCB_KeepoutRegion* parsePCBKeepoutRegionString(const std::string&);
-        PCB_CopperCircle* parsePCBCopperCircleString(const std::string&);
-        PCB_GraphicalCircle* parsePCBGraphicalCircleString(const std::string&);
-        PCB_CopperArc* parsePCBCopperArcString(const std::string&);
-        PCB_GraphicalArc* parsePCBGraphicalArcString(const std::string&);
-        PCB_Rect* parsePCBRectString(const std::string&);
-        PCB_Text* parsePCBTextString(const std::string&);
-        PCB_Module* parsePCBModuleString(const std::string& LCJSONString, EDADocument* parent = nullptr,
-                                         map<string, RAIIC<EDADocument>>* exportedList = nullptr);
-
-        bool judgeIsOnCopperLayer(const KiCadLayerIndex layerKiCad);
-        
-        Schematic_Pin* parseSchPin(const std::string&) const;
-        Schematic_Polyline* parseSchPolyline(const std::string&) const;
-        Schematic_Polygon* parseSchPolygon(const std::string&) const;
-        Schematic_Text* parseSchText(const std::string&) const;
-        Schematic_Rect* parseSchRect(const std::string&) const;
-        Schematic_Arc* parseSchArc(const std::string&) const;
-        Schematic_Module* parseSchModuleString(const std::string& LCJSONString, EDADocument* parent = nullptr,
-                                         map<string, RAIIC<EDADocument>>* exportedList = nullptr);
+        PCB_Pad* parsePCBPadString(const pcbShapeContext&, const fieldList&) const;
+        PCB_Module* parsePCBDiscretePadString(const pcbShapeContext&, const fieldList&) const;
+        PCB_Hole* parsePCBHoleString(const pcbShapeContext&, const fieldList&) const;
+        PCB_Via* parsePCBViaString(const pcbShapeContext&, const fieldList&) const;
+        PCB_CopperTrack* parsePCBCopperTrackString(const pcbShapeContext&, const fieldList&) const;
+        PCB_GraphicalTrack* parsePCBGraphicalTrackString(const pcbShapeContext&, const fieldList&) const;
+        PCB_FloodFill* parsePCBFloodFillString(const pcbShapeContext&, const fieldList&) const;
+        PCB_GraphicalSolidRegion* parsePCBGraphicalSolidRegionString(const pcbShapeContext&, const fieldList&) const;
+        PCB_GraphicalTrack* parsePCBNpthRegionString(const pcbShapeContext&, const fieldList&) const;
+        PCB_FloodFill* parsePCBCopperSolidRegionString(const pcbShapeContext&, const fieldList&) const;
+        PCB_FloodFill* parsePCBPlaneZoneString(const pcbShapeContext&, const fieldView&) const;
+        PCB_KeepoutRegion* parsePCBKeepoutRegionString(const pcbShapeContext&, const fieldList&) const;
+        PCB_CopperCircle* parsePCBCopperCircleString(const pcbShapeContext&, const fieldList&) const;
+        PCB_GraphicalCircle* parsePCBGraphicalCircleString(const pcbShapeContext&, const fieldList&) const;
+        PCB_CopperArc* parsePCBCopperArcString(const pcbShapeContext&, const fieldList&) const;
+        PCB_GraphicalArc* parsePCBGraphicalArcString(const pcbShapeContext&, const fieldList&) const;
+        PCB_Rect* parsePCBRectString(const pcbShapeContext&, const fieldList&) const;
+        PCB_Text* parsePCBTextString(const pcbShapeContext&, const fieldList&) const;
+        PCB_Module* parsePCBModuleString(const pcbShapeContext&, const fieldView& LCJSONString,
+                                         nestedLibraryCache* exportedList = nullptr) const;
+        PCB_Module* parsePCBModuleHeader(const pcbShapeContext&, const fieldView& LCJSONString,
+                                         nestedLibraryCache* exportedList, pcbShapeContext &moduleContext,
+                                         fieldView &shapesString) const;
+        void parsePCBModuleShapes(const pcbShapeContext &moduleContext, const fieldView &shapesString,
+                                  PCB_Module *module) const;
+
+        Schematic_Pin* parseSchPin(const fieldView&) const;
+        Schematic_Polyline* parseSchPolyline(const fieldList&) const;
+        Schematic_Polygon* parseSchPolygon(const fieldList&) const;
+        Schematic_Text* parseSchText(const fieldList&) const;
+        Schematic_Rect* parseSchRect(const fieldList&) const;
+        Schematic_Arc* parseSchArc(const fieldList&) const;
+        Schematic_Module* parseSchModuleString(const fieldView& LCJSONString, EDADocument* parent = nullptr,
+                                         nestedLibraryCache* exportedList = nullptr);
         /*
         void parseSchImage(const std::string&) const;
         */
-        std::map<int, KiCadLayerIndex> EasyEdaToKiCadLayerMap
-        {
-          {0, Invalid},         // Placeholder.
-          {1, F_Cu},
-          {2, B_Cu},
-          {3, F_SilkS},
-          {4, B_SilkS},
-          {5, F_Paste},
-          {6, B_Paste},
-          {7, F_Mask},
-          {8, B_Mask},
-          {9, Invalid},
-          {10, Edge_Cuts},
-          {11, Invalid},        // Multilayer, for through holes, No such layer for KiCad
-          {12, Cmts_User},
-          {13, F_Fab},
-          {14, B_Fab},
-          {15, Eco1_User},      // Mechanical layer.
-          {16, Invalid},        // 3D Model layer.
-          {17, Invalid},        // Component outline layer.
-          {18, Invalid},        // Pin outline layer.
-          {19, Invalid},        // Through hole layer(graphical only).
-          {20, Invalid},        // Violation marker layer.
-          {21, In1_Cu},
-          {22, In2_Cu},
-          {23, In3_Cu},
-          {24, In4_Cu},
-          {25, In5_Cu},
-          {26, In6_Cu},
-          {27, In7_Cu},
-          {28, In8_Cu},
-          {29, In9_Cu},
-          {30, In10_Cu},
-          {31, In11_Cu},
-          {32, In12_Cu},
-          {33, In13_Cu},
-          {34, In14_Cu},
-          {35, In15_Cu},
-          {36, In16_Cu},
-          {37, In17_Cu},
-          {38, In18_Cu},
-          {39, In19_Cu},
-          {40, In20_Cu},
-          {41, In21_Cu},
-          {42, In22_Cu},
-          {43, In23_Cu},
-          {44, In24_Cu},
-          {45, In25_Cu},
-          {46, In26_Cu},
-          {47, In27_Cu},
-          {48, In28_Cu},
-          {49, In29_Cu},
-          {50, In30_Cu},
-          {99, F_CrtYd}, // Package Shape, equivalent to KiCad Courtyard but needs to take care of flipping
-          {100, Invalid}, // Pin Shape
-          {101, Invalid}, // Component marking
-        };
       private:
+        static const size_t parallelChunkLength = 65536; // Length of shape strings parsed as one task in parallel
+
+        unsigned int parallelParseThreads() const; // 0 for parsing on the calling thread only
+        pointRange endPolygonRange(const pcbShapeContext&, size_t firstPoint) const; // Simplifies it if asked to
+        void reportPolygonSimplification(const PCBDocument*) const;
+
         str_dbl_map internalCompatibilitySwitches;
         EDADocument *workingDocument = nullptr;
+        EDADocument *elementOwner = nullptr; // Where parsed schematic elements go; the working document, or a nested library. PCBs use pcbShapeContext
+        EasyEDAStreamReader *shapeStream = nullptr;
         double schematic_unit_coefficient;
-        bool processingModule, exportNestedLibs;
+        double curveTolerance = 1.0 / 1000.0 / tenmils_to_mm_coefficient; // Chord tolerance of curves, in EasyEDA units
+        double polygonTolerance = 0.0; // Simplification tolerance of polygons, in EasyEDA units
+        size_t polygonVertexBudget = 0;
+        bool simplifyPolygons = false;
+        bool mergeTracks = false; // Merge board level tracks after parsing PCBs
+        bool processingModule, exportNestedLibs; // processingModule: schematics only
     };
   }
 
@@ -27,6 +27,8 @@
 
   namespace lc2kicad
   {
+    class ConversionCache;
+
     class LC2KiCadCore
     {
       public:
@@ -39,7 +41,10 @@
         void processEasyEDA6DocumentObject(rapidjson::Value &, EDADocument *aBasicDocument,
                                            list<EDADocument *> &ret);
 
-        void deserializeFile(EDADocument*, std::string*);
+        std::string deserializeFile(EDADocument*, std::string*, std::string *capture = nullptr);
+        void convertFileCached(string &filePath, string &outputPath);
+
+        void setConversionCache(ConversionCache *cache) { conversionCache = cache; }
 
         KiCad_5_Deserializer* getDeserializer() { return internalDeserializer; };
         LCJSONSerializer* getSerializer() { return internalSerializer; };
@@ -48,6 +53,9 @@
         KiCad_5_Deserializer* internalDeserializer;
         LCJSONSerializer* internalSerializer;
         str_dbl_map coreParserArguments;
+        ConversionCache *conversionCache = nullptr;
+
+        bool streamLCFile(std::FILE*, EDADocument&, list<EDADocument *> &ret);
     };
   }
 
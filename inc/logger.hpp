@@ -0,0 +1,57 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LC2KICAD_LOGGER_HPP_
+  #define LC2KICAD_LOGGER_HPP_
+
+  #include <string>
+  #include <iostream>
+
+  namespace lc2kicad
+  {
+    enum class logLevel { error, warning, info };
+
+    /**
+     * Log backend behind Error, Warn, Info and VERBOSE_INFO.
+     *
+     * Messages are queued in a per-thread buffer and only formatted (colors, JSON) when the buffer is
+     * written out, so logging threads don't contend for the output stream. Errors are written out at once.
+     * Call flushLog() where the output should catch up, e.g. after each converted file.
+     *
+     * Warnings and info messages of the "<element id>: <text>" form are grouped by their text. Once a
+     * group has been logged repeatLimit times, by any threads, further ones are left off the console, and
+     * reported there in one line at the next flushLog(). Errors and verbose mode aren't limited. The JSON
+     * log, and the error and warning counters, take every message.
+     */
+    void logMessage(logLevel level, const std::string &message);
+    void flushLog(); // Writes out what the calling thread queued, and the repeat summaries of all threads
+
+    // Where console output goes. Defaults to standard output.
+    void setLogStream(std::ostream *stream);
+    // Also write every message as a JSON object per line into this file. Returns false if it can't be opened.
+    bool openJSONLog(const std::string &path);
+    // Input file the calling thread starts working on, reported in JSON log lines. Writes out what's queued.
+    void setLogContext(const std::string &inputFile);
+    std::string logContext(); // Of the calling thread
+
+    long loggedErrorCount();
+    long loggedWarningCount();
+  }
+
+#endif
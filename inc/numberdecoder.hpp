@@ -0,0 +1,46 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LC2KICAD_NUMBERDECODER_HPP_
+  #define LC2KICAD_NUMBERDECODER_HPP_
+
+  namespace lc2kicad
+  {
+    enum class numberError { none, invalid, outOfRange };
+
+    struct numberResult
+    {
+      const char *ptr;   // First character not consumed
+      numberError error;
+    };
+
+    /**
+     * Decode a number from the character range [first, last), in the manner of C++17 std::from_chars.
+     * Nothing is allocated, the locale is never consulted, and nothing is thrown. On error, value is
+     * left untouched and ptr equals first.
+     *
+     * For compatibility with the std::stod/std::stoi calls these replace, leading spaces and an
+     * explicit '+' sign are accepted too. Decimal numbers are decoded exactly; simple ones take a
+     * fast path, the rest fall back to RapidJSON's full precision conversion.
+     */
+    numberResult decodeNumber(const char *first, const char *last, double &value);
+    numberResult decodeNumber(const char *first, const char *last, int &value);
+  }
+
+#endif
@@ -0,0 +1,96 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LC2KICAD_OUTPUTBUFFER_HPP_
+  #define LC2KICAD_OUTPUTBUFFER_HPP_
+
+  #include <cstddef>
+  #include <cstring>
+  #include <memory>
+  #include <ostream>
+  #include <string>
+
+  namespace lc2kicad
+  {
+    /**
+     * Append-only buffer in front of an output stream. Deserializers write documents into it piece by
+     * piece, and it only hands them to the stream in large chunks, or on flush().
+     *
+     * Numbers are formatted straight into the buffer, so nothing written through here needs a temporary
+     * string. Integers look like std::to_string's; doubles are rounded to a fixed number of decimal places
+     * (6 by default, which is 1nm in mm) and printed without trailing zeros, e.g. 2.54 rather than 2.540000.
+     */
+    class OutputBuffer
+    {
+      public:
+        explicit OutputBuffer(std::ostream &sink, size_t chunkSize = 65536);
+        ~OutputBuffer();
+
+        void append(const char *data, size_t length)
+        {
+          if(length > capacity - used)
+          {
+            flush();
+            if(length >= capacity) // Won't fit in a chunk anyway
+            {
+              sink.write(data, static_cast<std::streamsize>(length));
+              return;
+            }
+          }
+          std::memcpy(buffer.get() + used, data, length);
+          used += length;
+        }
+
+        OutputBuffer& operator<<(const std::string &str) { append(str.data(), str.size()); return *this; }
+        OutputBuffer& operator<<(const char *str) { append(str, std::strlen(str)); return *this; }
+        OutputBuffer& operator<<(char c)
+        {
+          if(used == capacity)
+            flush();
+          buffer[used++] = c;
+          return *this;
+        }
+
+        OutputBuffer& operator<<(int value) { return *this << static_cast<long long>(value); }
+        OutputBuffer& operator<<(long value) { return *this << static_cast<long long>(value); }
+        OutputBuffer& operator<<(long long value);
+        OutputBuffer& operator<<(unsigned int value) { return *this << static_cast<unsigned long long>(value); }
+        OutputBuffer& operator<<(unsigned long value) { return *this << static_cast<unsigned long long>(value); }
+        OutputBuffer& operator<<(unsigned long long value);
+        OutputBuffer& operator<<(double value);
+
+        // Decimal places doubles are rounded to, at most maxDecimalPlaces
+        void setDecimalPlaces(unsigned int places) { decimalPlaces = places < maxDecimalPlaces ? places : maxDecimalPlaces; }
+        static const unsigned int maxDecimalPlaces = 9;
+
+        // Hand everything buffered to the stream
+        void flush();
+
+        OutputBuffer(const OutputBuffer&) = delete;
+        OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+      private:
+        std::ostream &sink;
+        std::unique_ptr<char[]> buffer;
+        size_t capacity, used = 0;
+        unsigned int decimalPlaces = 6;
+    };
+  }
+
+#endif
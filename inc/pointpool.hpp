@@ -0,0 +1,111 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LC2KICAD_POINTPOOL_HPP_
+  #define LC2KICAD_POINTPOOL_HPP_
+
+  #include <cstddef>
+  #include <vector>
+
+  #include "includes.hpp"
+
+  namespace lc2kicad
+  {
+    class PointPool;
+
+    /**
+     * A run of points inside a PointPool, which is what track and region elements hold instead of
+     * their own point lists. Reads like a read-only coordslist; points are returned by value.
+     */
+    class pointRange
+    {
+      public:
+        class iterator
+        {
+          public:
+            iterator(const pointRange *range, size_t index) : range(range), index(index) { }
+            coordinates operator*() const { return (*range)[index]; }
+            iterator& operator++() { index++; return *this; }
+            bool operator!=(const iterator &other) const { return index != other.index; }
+          private:
+            const pointRange *range;
+            size_t index;
+        };
+
+        pointRange() { }
+        pointRange(const PointPool *pool, size_t offset, size_t count) : pool(pool), offset(offset), count(count) { }
+
+        size_t size() const { return count; }
+        bool empty() const { return !count; }
+        inline coordinates operator[](size_t index) const;
+        iterator begin() const { return iterator(this, 0); }
+        iterator end() const { return iterator(this, count); }
+
+      private:
+        const PointPool *pool = nullptr;
+        size_t offset = 0, count = 0;
+    };
+
+    /**
+     * Per-document structure-of-arrays store for the points of tracks and regions.
+     *
+     * Serializers append points as they are read, untransformed, in ranges opened with beginRange().
+     * Each range remembers the origin and scale in effect at the time (footprints have their own
+     * origin), and consecutive ranges with the same ones share a single run. transform() then shifts
+     * and scales every pending run in one pass over the X and Y arrays, which the compiler can
+     * vectorize. Points must not be read before that.
+     */
+    class PointPool
+    {
+      public:
+        // Start a range of raw points that transform() will map to (point - origin) * scale
+        size_t beginRange(coordinates origin, double scale);
+        void append(double x, double y) { X.push_back(x), Y.push_back(y); }
+        void append(coordinates point) { X.push_back(point.X), Y.push_back(point.Y); }
+        pointRange endRange(size_t first) const { return pointRange(this, first, X.size() - first); }
+        // Append count points to be written through dataX() and dataY(); returns the index of the first one
+        size_t grow(size_t count) { X.resize(X.size() + count), Y.resize(Y.size() + count); return X.size() - count; }
+        double *dataX(size_t index) { return X.data() + index; }
+        double *dataY(size_t index) { return Y.data() + index; }
+        // Drop the points from index size on, which must all be in the range opened last
+        void truncate(size_t size) { X.resize(size), Y.resize(size); }
+
+        // Apply origin shift and scale to all points appended since the last call
+        void transform();
+
+        size_t size() const { return X.size(); }
+        coordinates at(size_t index) const { return coordinates(X[index], Y[index]); }
+
+      private:
+        struct run
+        {
+          size_t first;
+          coordinates origin;
+          double scale;
+        };
+
+        std::vector<double> X, Y;
+        std::vector<run> pendingRuns;
+    };
+
+    coordinates pointRange::operator[](size_t index) const { return pool->at(offset + index); }
+  }
+
+#endif
@@ -0,0 +1,42 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LC2KICAD_POLYGONSIMPLIFIER_HPP_
+  #define LC2KICAD_POLYGONSIMPLIFIER_HPP_
+
+  #include <cstddef>
+
+  namespace lc2kicad
+  {
+    /**
+     * Simplify the closed polygon of count points in x and y, in place, and return how many points are left
+     * at the front of the arrays.
+     *
+     * Points closer than tolerance to the last point kept are dropped first, along with a last point
+     * repeating the first; where that would leave fewer than 3, only repeated points are dropped. Then
+     * Douglas–Peucker is run on the ring, putting back the point farthest from the outline kept so far
+     * until every point dropped is within tolerance of it, or vertexBudget points (0 for no budget) are
+     * kept. Collinear points therefore always go. Points keep their order, and at least 3 are kept
+     * whatever the tolerance or budget, unless there were fewer distinct ones to begin with.
+     */
+    size_t simplifyPolygon(double *x, double *y, size_t count, double tolerance, size_t vertexBudget);
+  }
+
+#endif
@@ -0,0 +1,53 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LC2KICAD_SHA256_HPP_
+  #define LC2KICAD_SHA256_HPP_
+
+  #include <cstddef>
+  #include <cstdint>
+  #include <string>
+
+  namespace lc2kicad
+  {
+    /**
+     * SHA-256 (FIPS 180-4), for keys that must not collide even across many runs, like the ones of the
+     * persistent conversion cache. Feed data with update() as often as needed, then take hexDigest() once.
+     */
+    class SHA256
+    {
+      public:
+        SHA256();
+
+        void update(const void *data, size_t length);
+        void update(const std::string &data) { update(data.data(), data.size()); }
+        std::string hexDigest();
+
+      private:
+        void processBlock(const uint8_t *block);
+
+        uint32_t state[8];
+        uint8_t buffer[64];
+        size_t bufferedBytes = 0;
+        uint64_t totalBytes = 0;
+    };
+  }
+
+#endif
@@ -15,332 +15,146 @@
 #define SMOLSVG_PATHREADER_H
 
 #include "svgpath.hpp"
+#include "numberdecoder.hpp"
 #include <string>
 #include <vector>
 
 namespace SmolSVG
 {
-  SVGRawPath *readPathString(std::string &pathStr);
+  enum class pathError { none, invalidCommand, invalidNumber, missingArguments };
 
-  static SmolCoord realCoord(const bool relative, const SmolCoord &pen, const double X, const double Y)
+  inline const char* pathErrorMessage(pathError error)
   {
-    return relative ? (SmolCoord(X, Y) + pen) : SmolCoord(X, Y);
+    switch(error)
+    {
+      case pathError::none: return "No error";
+      case pathError::invalidCommand: return "Unknown or invalid SVG command";
+      case pathError::invalidNumber: return "Invalid number amongst arguments";
+      case pathError::missingArguments: return "Too few arguments for SVG command";
+    }
+    return "";
   }
 
-  static SmolCoord realCoord(const bool relative, const SmolCoord &pen, const std::vector<double> &argCache,
-                             size_t coordPos)
+  // Arguments an SVG path command takes; -1 for unknown commands
+  inline int pathArgumentCount(char command)
   {
-    return relative ?
-                      (SmolCoord(argCache[coordPos], argCache[coordPos + 1]) + pen) :
-                      SmolCoord(argCache[coordPos], argCache[coordPos + 1]);
+    switch(command)
+    {
+      case 'Z': case 'z': return 0;
+      case 'H': case 'h': case 'V': case 'v': return 1;
+      case 'M': case 'm': case 'L': case 'l': case 'T': case 't': return 2;
+      case 'S': case 's': case 'Q': case 'q': return 4;
+      case 'C': case 'c': return 6;
+      case 'A': case 'a': return 7;
+      default: return -1;
+    }
   }
 
-  SVGRawPath *readPathString(std::string &pathStr)
+  /**
+   * Decode the SVG path in [first, last) into path, which is cleared first. Nothing is thrown, and once
+   * path has grown to the size of the largest path read into it, nothing is allocated either.
+   *
+   * Coordinates come out absolute. Move-tos only move the pen (further coordinate pairs after one are
+   * line-tos), and close-paths, horizontal and vertical lines come out as line-tos. The segments read
+   * before an error are left in path.
+   */
+  inline pathError readPath(const char *first, const char *last, pathBuffer &path)
   {
-    SVGRawPath *retptr = new SVGRawPath;
-    SVGRawPath &ret = *retptr;
-    SmolCoord PenLocation, CloseAt;
-    std::vector<double> argCache;
-
-    std::string::const_iterator cutBegin;
-    unsigned int remainingArgCount = 0, commandArgCount = 0;
-    bool relativeToken = false, finishAfterGeneration = false;
-    enum { SkipSpacer, ReadCommand, ReadArgs, GenerateCommandObject } status = SkipSpacer;
-    commandType commandToken;
-
-    auto endByte = pathStr.cend() - 1;
+    path.clear();
+    SmolCoord pen, subpathStart, lastHandle;
+    commandType lastType = Invalid; // Smooth curves only reflect the handle of a curve of their kind
+    char command = 0;
+    double args[7];
 
-    for(std::string::const_iterator i = pathStr.cbegin(); i < pathStr.cend(); )
+    for(const char *i = first; ; )
     {
-      switch(status)
-      {
-        case SkipSpacer:
-          if(*i == ' ' || *i == ',')
-            i++;
-          else if(*i >= 'A' && *i <= 'z')
-          {
-            if(!remainingArgCount)
-              status = ReadCommand;
-            else
-              throw std::logic_error("Unexpected command amongst arguments");
-          }
-          else if(*i >= '-' && *i <= '9')
-          {
-            if(remainingArgCount == 0)
-            {
-              remainingArgCount = commandArgCount;
-              argCache.clear();
-            }
-            status = ReadArgs;
-            cutBegin = i;
-          }
-          break;
-
-        case ReadCommand:
-          argCache.clear();
-          switch(*i)
-          {
-            case 'm':
-              relativeToken = true;
-              commandToken = MoveTo;
-              remainingArgCount = commandArgCount = 2;
-              status = SkipSpacer;
-              break;
-
-            case 'M':
-              relativeToken = false;
-              commandToken = MoveTo;
-              remainingArgCount = commandArgCount = 2;
-              status = SkipSpacer;
-              break;
-
-            case 'z':
-              relativeToken = true;
-              commandToken = ClosePath;
-              remainingArgCount = commandArgCount = 0;
-              status = GenerateCommandObject; // Because 'z' token has to be closed immediately
-              break;
-
-            case 'Z':
-              relativeToken = false;
-              commandToken = ClosePath;
-              remainingArgCount = commandArgCount = 0;
-              status = GenerateCommandObject;
-              break;
-
-            case 'l':
-              relativeToken = true;
-              commandToken = LineTo;
-              remainingArgCount = commandArgCount = 2;
-              status = SkipSpacer;
-              break;
-
-            case 'L':
-              relativeToken = false;
-              commandToken = LineTo;
-              remainingArgCount = commandArgCount = 2;
-              status = SkipSpacer;
-              break;
-
-            case 'v':
-              relativeToken = true;
-              commandToken = VerticalTo;
-              remainingArgCount = commandArgCount = 1;
-              status = SkipSpacer;
-              break;
-
-            case 'V':
-              relativeToken = false;
-              commandToken = VerticalTo;
-              remainingArgCount = commandArgCount = 1;
-              status = SkipSpacer;
-              break;
-
-            case 'h':
-              relativeToken = true;
-              commandToken = HorizontalTo;
-              remainingArgCount = commandArgCount = 1;
-              status = SkipSpacer;
-              break;
-
-            case 'H':
-              relativeToken = false;
-              commandToken = HorizontalTo;
-              remainingArgCount = commandArgCount = 1;
-              status = SkipSpacer;
-              break;
-
-            case 'c':
-              relativeToken = true;
-              commandToken = CurveTo;
-              remainingArgCount = commandArgCount = 6;
-              status = SkipSpacer;
-              break;
-
-            case 'C':
-              relativeToken = false;
-              commandToken = CurveTo;
-              remainingArgCount = commandArgCount = 6;
-              status = SkipSpacer;
-              break;
-
-            case 's':
-              relativeToken = true;
-              commandToken = SmoothTo;
-              remainingArgCount = commandArgCount = 4;
-              status = SkipSpacer;
-              break;
-
-            case 'S':
-              relativeToken = false;
-              commandToken = SmoothTo;
-              remainingArgCount = commandArgCount = 4;
-              status = SkipSpacer;
-              break;
-
-            case 'q':
-              relativeToken = true;
-              commandToken = QuadTo;
-              remainingArgCount = commandArgCount = 4;
-              status = SkipSpacer;
-              break;
-
-            case 'Q':
-              relativeToken = false;
-              commandToken = QuadTo;
-              remainingArgCount = commandArgCount = 4;
-              status = SkipSpacer;
-              break;
+      while(i != last && (*i == ' ' || *i == ','))
+        i++;
+      if(i == last)
+        return pathError::none;
 
-            case 't':
-              relativeToken = true;
-              commandToken = SmoothQuadTo;
-              remainingArgCount = commandArgCount = 2;
-              status = SkipSpacer;
-              break;
-
-            case 'T':
-              relativeToken = false;
-              commandToken = SmoothQuadTo;
-              remainingArgCount = commandArgCount = 2;
-              status = SkipSpacer;
-              break;
-
-            case 'a':
-              relativeToken = true;
-              commandToken = ArcTo;
-              remainingArgCount = commandArgCount = 7;
-              status = SkipSpacer;
-              break;
-
-            case 'A':
-              relativeToken = false;
-              commandToken = ArcTo;
-              remainingArgCount = commandArgCount = 7;
-              status = SkipSpacer;
-              break;
+      if((*i >= 'A' && *i <= 'Z') || (*i >= 'a' && *i <= 'z')) // Numbers can't begin with a letter
+      {
+        command = *i++;
+        int argumentCount = pathArgumentCount(command);
+        if(argumentCount < 0)
+          return pathError::invalidCommand;
+        if(!argumentCount) // Close path, which is always drawn, even when it's got zero length
+        {
+          path.addSegment(LineTo, pen, subpathStart);
+          pen = subpathStart;
+          lastType = ClosePath;
+          continue;
+        }
+      }
+      else if(!command || !pathArgumentCount(command)) // Arguments without a command, or after a close path
+        return pathError::invalidCommand;
 
-            default:
-              throw std::logic_error("Unknown or invalid SVG command");
-          }
+      int argumentCount = pathArgumentCount(command);
+      for(int j = 0; j < argumentCount; j++)
+      {
+        while(i != last && (*i == ' ' || *i == ','))
+          i++;
+        if(i == last)
+          return pathError::missingArguments;
+        lc2kicad::numberResult result = lc2kicad::decodeNumber(i, last, args[j]);
+        if(result.error != lc2kicad::numberError::none)
+          return pathError::invalidNumber;
+        i = result.ptr;
+      }
 
-          if(i + 1 == pathStr.cend())
-            status = GenerateCommandObject;
-          else
-            i++;
+      bool relative = command >= 'a';
+      SmolCoord base = relative ? pen : SmolCoord();
+      auto argumentPoint = [&](int index) { return SmolCoord(args[index], args[index + 1]) + base; };
+      SmolCoord handle;
 
+      switch(command)
+      {
+        case 'M': case 'm':
+          subpathStart = pen = argumentPoint(0);
+          command = relative ? 'l' : 'L';
+          lastType = MoveTo;
+          continue;
+        case 'L': case 'l':
+          path.addSegment(LineTo, pen, argumentPoint(0));
+          lastType = LineTo;
           break;
-
-        case ReadArgs:
-        {
-          bool exitSwitch = false;
-          while(*i >= '-' && *i <= '9')
-            if(i == endByte)
-            {
-              status = GenerateCommandObject;
-              finishAfterGeneration = true;
-              break;
-            }
-            else
-              i++;
-          argCache.emplace_back(std::stod(std::string(cutBegin, i + 1)));
-          remainingArgCount--;
-          if(remainingArgCount)
-            status = SkipSpacer;
-          else
-            status = GenerateCommandObject;
+        case 'H': case 'h':
+          path.addSegment(LineTo, pen, SmolCoord(args[0] + base.X, pen.Y));
+          lastType = LineTo;
           break;
-        }
-
-        case GenerateCommandObject:
-        {
-          baseCommand *lastCommand;
-
-          switch(commandToken)
-          {
-            case MoveTo:
-              CloseAt = PenLocation = { argCache[0], argCache[1] };
-              break;
-            case ClosePath:
-              ret.addRawCommand(new commandLineTo(PenLocation, CloseAt));
-              PenLocation = CloseAt;
-              i++; // Because it doesn't have args, no one will increment i for it
-              break;
-            case LineTo:
-              ret.addRawCommand(new commandLineTo(PenLocation,
-                                          realCoord(relativeToken, PenLocation, argCache, 0)));
-              PenLocation = ret.getLastCommand()->getConstEndPoint();
-              break;
-            case VerticalTo:
-              ret.addRawCommand(new commandLineTo(PenLocation,
-                                          realCoord(relativeToken, PenLocation, relativeToken ? 0 : PenLocation.X, argCache[0])));
-              PenLocation = ret.getLastCommand()->getConstEndPoint();
-              break;
-            case HorizontalTo:
-              ret.addRawCommand(new commandLineTo(PenLocation,
-                                          realCoord(relativeToken, PenLocation, argCache[0], relativeToken ? 0 : PenLocation.Y)));
-              PenLocation = ret.getLastCommand()->getConstEndPoint();
-              break;
-            case CurveTo:
-              ret.addRawCommand(new commandCubicBezierTo(PenLocation,
-                                                 realCoord(relativeToken, PenLocation, argCache, 0),
-                                                 realCoord(relativeToken, PenLocation, argCache, 2),
-                                                 realCoord(relativeToken, PenLocation, argCache, 4)));
-              PenLocation = ret.getLastCommand()->getConstEndPoint();
-              break;
-            case SmoothTo:
-              lastCommand = ret.getLastCommand();
-              if(lastCommand->type() == CurveTo)
-                ret.addRawCommand(new commandCubicBezierTo(PenLocation,
-                                                   PenLocation * 2 - dynamic_cast<commandCubicBezierTo *>(lastCommand)->getHandleB(),
-                                                   realCoord(relativeToken, PenLocation, argCache, 0),
-                                                   realCoord(relativeToken, PenLocation, argCache, 2)));
-              else
-                ret.addRawCommand(new commandCubicBezierTo(PenLocation,
-                                                   PenLocation * 2 - lastCommand->getConstEndPoint(),
-                                                   realCoord(relativeToken, PenLocation, argCache, 0),
-                                                   realCoord(relativeToken, PenLocation, argCache, 2)));
-              PenLocation = ret.getLastCommand()->getConstEndPoint();
-              break;
-            case QuadTo:
-              ret.addRawCommand(new commandQuadraticBezierTo(PenLocation,
-                                                     realCoord(relativeToken, PenLocation, argCache, 0),
-                                                     realCoord(relativeToken, PenLocation, argCache, 2)));
-              PenLocation = ret.getLastCommand()->getConstEndPoint();
-              break;
-            case SmoothQuadTo:
-              lastCommand = ret.getLastCommand();
-              if(lastCommand->type() == QuadTo)
-                ret.addRawCommand(new commandQuadraticBezierTo(PenLocation,
-                                                       PenLocation * 2 - dynamic_cast<commandQuadraticBezierTo *>(lastCommand)->getHandle(),
-                                                       realCoord(relativeToken, PenLocation, argCache, 0)));
-              else
-                ret.addRawCommand(new commandQuadraticBezierTo(PenLocation,
-                                                       PenLocation * 2 - lastCommand->getConstEndPoint(),
-                                                       realCoord(relativeToken, PenLocation, argCache, 0)));
-              PenLocation = ret.getLastCommand()->getConstEndPoint();
-              break;
-            case ArcTo:
-              ret.addRawCommand(new commandEllipticalArcTo(PenLocation,
-                                                   { argCache[0], argCache[1] },
-                                                   argCache[2], argCache[3] == 1.0, argCache[4] == 1.0,
-                                                   realCoord(relativeToken, PenLocation, argCache, 5)));
-              PenLocation = ret.getLastCommand()->getConstEndPoint();
-              break;
-            default:
-              throw std::logic_error("Unknown token enumeration");
-          }
-          status = SkipSpacer;
-          if(finishAfterGeneration)
-            i++; // Args at end
+        case 'V': case 'v':
+          path.addSegment(LineTo, pen, SmolCoord(pen.X, args[0] + base.Y));
+          lastType = LineTo;
+          break;
+        case 'C': case 'c':
+          lastHandle = argumentPoint(2);
+          path.addSegment(CurveTo, pen, argumentPoint(0), lastHandle, argumentPoint(4));
+          lastType = CurveTo;
+          break;
+        case 'S': case 's':
+          handle = lastType == CurveTo ? pen * 2 - lastHandle : pen;
+          lastHandle = argumentPoint(0);
+          path.addSegment(CurveTo, pen, handle, lastHandle, argumentPoint(2));
+          lastType = CurveTo;
+          break;
+        case 'Q': case 'q':
+          lastHandle = argumentPoint(0);
+          path.addSegment(QuadTo, pen, lastHandle, argumentPoint(2));
+          lastType = QuadTo;
+          break;
+        case 'T': case 't':
+          lastHandle = lastType == QuadTo ? pen * 2 - lastHandle : pen;
+          path.addSegment(QuadTo, pen, lastHandle, argumentPoint(0));
+          lastType = QuadTo;
+          break;
+        case 'A': case 'a':
+          path.addArc(pen, SmolCoord(args[0], args[1]), args[2], args[3] == 1.0, args[4] == 1.0, argumentPoint(5));
+          lastType = ArcTo;
           break;
-        }
-        default:;
       }
-
+      pen = path.endPoint(path.back());
     }
-
-    return retptr;
   }
 }
 
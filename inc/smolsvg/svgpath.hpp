@@ -14,38 +14,78 @@
 #ifndef SMOLSVG_SVGPATH_HPP
 #define SMOLSVG_SVGPATH_HPP
 
+#include <vector>
 #include "svgcommands.hpp"
 
 namespace SmolSVG
 {
-  class SVGRawPath
+  /**
+   * A decoded path, kept flat: one tagged record per segment in one array, and the points of all
+   * segments in another. Meant to be kept around and read into again, so its storage gets reused.
+   *
+   * The points of a segment are its start point, then its handle(s) for curves or its radii for arcs,
+   * then its end point.
+   */
+  class pathBuffer
   {
-      std::list<baseCommand*> commandStorage;
     public:
-      std::list<baseCommand *>::const_iterator begin() const { return commandStorage.cbegin(); }
-      std::list<baseCommand *>::const_iterator end() const { return commandStorage.cend(); }
-      std::list<baseCommand *>::iterator mbegin() { return commandStorage.begin();  } // Mutable iterator
-      std::list<baseCommand *>::iterator mend() { return commandStorage.end(); }
-      void addRawCommand(baseCommand* cmd) { commandStorage.emplace_back(cmd); }
-      baseCommand* getLastCommand() { return commandStorage.back(); };
-      void purgeLastCommand() { commandStorage.pop_back(); }
-      void purgeDestroyLastCommand()
+      struct segment
       {
-        if(commandStorage.size())
-          delete commandStorage.back(), purgeLastCommand();
+        commandType type;        // LineTo, QuadTo, CurveTo or ArcTo
+        bool largeArc, sweep;    // ArcTo only
+        double XAxisRotation;    // ArcTo only
+        unsigned int firstPoint; // Index of the start point in the point array
+      };
+
+      static unsigned int pointCount(commandType type)
+      {
+        switch(type)
+        {
+          case QuadTo: case ArcTo: return 3;
+          case CurveTo: return 4;
+          default: return 2;
+        }
+      }
+
+      void clear() { segments.clear(), points.clear(); }
+      bool empty() const { return segments.empty(); }
+      size_t size() const { return segments.size(); }
+      const segment& operator[](size_t index) const { return segments[index]; }
+      const segment& back() const { return segments.back(); }
+      std::vector<segment>::const_iterator begin() const { return segments.cbegin(); }
+      std::vector<segment>::const_iterator end() const { return segments.cend(); }
+
+      const SmolCoord& startPoint(const segment &s) const { return points[s.firstPoint]; }
+      const SmolCoord& endPoint(const segment &s) const { return points[s.firstPoint + pointCount(s.type) - 1]; }
+      const SmolCoord& point(const segment &s, unsigned int index) const { return points[s.firstPoint + index]; }
+      const SmolCoord& radii(const segment &s) const { return points[s.firstPoint + 1]; }
+
+      void addSegment(commandType type, const SmolCoord &from, const SmolCoord &to)
+      {
+        segments.push_back({ type, false, false, 0.0, static_cast<unsigned int>(points.size()) });
+        points.push_back(from), points.push_back(to);
       }
-      SVGRawPath()
+      void addSegment(commandType type, const SmolCoord &from, const SmolCoord &handle, const SmolCoord &to)
       {
-        commandStorage.clear();
+        segments.push_back({ type, false, false, 0.0, static_cast<unsigned int>(points.size()) });
+        points.push_back(from), points.push_back(handle), points.push_back(to);
       }
-      ~SVGRawPath()
+      void addSegment(commandType type, const SmolCoord &from, const SmolCoord &handleA, const SmolCoord &handleB,
+                      const SmolCoord &to)
       {
-        for (auto &i : commandStorage)
-        {
-          if (i != nullptr)
-            delete i, i = nullptr;
-        }
+        segments.push_back({ type, false, false, 0.0, static_cast<unsigned int>(points.size()) });
+        points.push_back(from), points.push_back(handleA), points.push_back(handleB), points.push_back(to);
       }
+      void addArc(const SmolCoord &from, const SmolCoord &radii, double XAxisRotation, bool largeArc, bool sweep,
+                  const SmolCoord &to)
+      {
+        segments.push_back({ ArcTo, largeArc, sweep, XAxisRotation, static_cast<unsigned int>(points.size()) });
+        points.push_back(from), points.push_back(radii), points.push_back(to);
+      }
+
+    private:
+      std::vector<segment> segments;
+      std::vector<SmolCoord> points;
   };
 }
 
@@ -0,0 +1,74 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LC2KICAD_STREAMREADER_HPP_
+  #define LC2KICAD_STREAMREADER_HPP_
+
+  #include <cstdio>
+  #include <memory>
+  #include <functional>
+
+  #include "rapidjson.hpp"
+  #include "fieldview.hpp"
+
+  namespace lc2kicad
+  {
+    /**
+     * Streaming (SAX) reader for EasyEDA 6 documents, used by the streaming parse mode.
+     *
+     * The full DOM is never built. Only "head", "canvas" and "DRCRULE" are kept, in a small Document
+     * that otherwise looks like the real one with an empty "shape" array, so the usual document-level
+     * serializer code can run on it. EasyEDA writes "DRCRULE" after the shapes, so it only shows up in
+     * that Document once readShapes() is done. The shape strings are handed out one by one as they're read,
+     * and are only valid during the callback. Peak memory is therefore bounded by the largest shape
+     * string, not by the file size.
+     *
+     * Shapes that appear in the file before the head and canvas are known have to be buffered.
+     * EasyEDA writes head and canvas first, so this normally doesn't happen.
+     */
+    class EasyEDAStreamReader
+    {
+      public:
+        typedef std::function<void(const fieldView&)> shapeConsumer;
+
+        explicit EasyEDAStreamReader(std::FILE *file);
+        ~EasyEDAStreamReader();
+
+        // Read until head and canvas are both known. Returns false if the document ended without them,
+        // which means it isn't a single document (e.g. a schematics project) and can't be streamed.
+        bool readHeader();
+        // The small Document with head, canvas and DRC rules. Valid after readHeader(); the DRC rules
+        // are only in it from there if they came before the shapes, else after readShapes().
+        std::shared_ptr<rapidjson::Document> headerDocument() const { return header; }
+        // Read the rest of the document, passing every shape string to the consumer.
+        void readShapes(const shapeConsumer &consumer);
+
+        EasyEDAStreamReader(const EasyEDAStreamReader&) = delete;
+        EasyEDAStreamReader& operator=(const EasyEDAStreamReader&) = delete;
+
+      private:
+        struct streamState;
+        std::unique_ptr<streamState> state;
+        std::shared_ptr<rapidjson::Document> header;
+
+        void readUntil(const std::function<bool()> &stopCondition);
+    };
+  }
+
+#endif
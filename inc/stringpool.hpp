@@ -0,0 +1,72 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LC2KICAD_STRINGPOOL_HPP_
+  #define LC2KICAD_STRINGPOOL_HPP_
+
+  #include <string>
+  #include <unordered_set>
+
+  #include "fieldview.hpp"
+
+  namespace lc2kicad
+  {
+    /**
+     * Handle to a string kept by a StringPool. A pool stores every distinct string once, so two
+     * handles from the same pool are equal exactly when their strings are, and compare by pointer.
+     * A default constructed handle is the empty string, which is also what pools give out for "".
+     */
+    class internedString
+    {
+      public:
+        internedString() : text(&emptyString) { }
+
+        const std::string& str() const { return *text; }
+        operator const std::string&() const { return *text; }
+        bool empty() const { return text->empty(); }
+
+        bool operator==(const internedString &other) const { return text == other.text; }
+        bool operator!=(const internedString &other) const { return text != other.text; }
+
+      private:
+        friend class StringPool;
+        explicit internedString(const std::string *text) : text(text) { }
+
+        static const std::string emptyString;
+        const std::string *text;
+    };
+
+    /**
+     * Per-document interning table for the strings elements repeat a lot, like c_para keys and
+     * values and pin numbers. Strings stay put until the pool goes away, so handles never dangle
+     * while the document is alive.
+     */
+    class StringPool
+    {
+      public:
+        internedString intern(const fieldView &str);
+        size_t size() const { return strings.size(); }
+
+      private:
+        std::unordered_set<std::string> strings;
+    };
+  }
+
+#endif
@@ -0,0 +1,53 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LC2KICAD_TRACKMERGER_HPP_
+  #define LC2KICAD_TRACKMERGER_HPP_
+
+  #include <cstddef>
+
+  namespace lc2kicad
+  {
+    struct PCBDocument;
+
+    struct trackMergeResult
+    {
+      size_t segmentsBefore, segmentsAfter;
+    };
+
+    /**
+     * Rewrite the board level tracks of a parsed (and transformed) PCB document with fewer segments.
+     *
+     * Repeated points and tracks of zero length are dropped. Tracks of the same kind, net, layer and width
+     * that end at the same point, and no other track of their group does, are joined into one. Then
+     * points lying on the straight line between their neighbours are dropped.
+     *
+     * Copper tracks keep every point something else touches, so connections KiCad makes from segment end
+     * points stay: other tracks, arcs and circles on the layer, pads and vias, and the bounding boxes of
+     * fills, regions and rectangles on the layer all keep the points they touch, and track ends there
+     * stay apart.
+     *
+     * Rewritten tracks get their points from new ranges in the document's point pool. Tracks merged into
+     * others, and the ones of zero length, are taken out of the document.
+     */
+    trackMergeResult mergePCBTracks(PCBDocument &document);
+  }
+
+#endif
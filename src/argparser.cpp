@@ -32,7 +32,7 @@ namespace lc2kicad
     bool noDoubleDash = true;
     char currentShortSwitch = 0;
     programArgumentParseResult ret;
-    enum { none, configFile, outputDirectory, parserArgument } status = none;
+    enum { none, configFile, outputDirectory, parserArgument, jobCount, logFile, cacheDirectory } status = none;
 
     if(argc == 1)
     {
@@ -89,6 +89,10 @@ namespace lc2kicad
           case 'l': // Export nested libraries
             ret.exportNestedLibs = true;
             break;
+          case 'j': // Number of conversion workers
+            status = jobCount;
+            remainingArgs = 1;
+            break;
           default:
             assertThrow(false, string("Error: unrecognized switch \"-") + currentShortSwitch + "\"");
             break;
@@ -102,6 +106,16 @@ namespace lc2kicad
           ret.invokeVersionInfo = true;
         else if(!strcmp(argv[i], "--pipe"))
           ret.usePipe = true;
+        else if(!strcmp(argv[i], "--log-json"))
+        {
+          status = logFile;
+          remainingArgs = 1;
+        }
+        else if(!strcmp(argv[i], "--cache-dir"))
+        {
+          status = cacheDirectory;
+          remainingArgs = 1;
+        }
 
         else if(remainingArgs > 0) // Not long switches, then it could only be arguments for a switch.
         {
@@ -117,6 +131,17 @@ namespace lc2kicad
             case outputDirectory:
               ret.outputDirectory = argv[i];
               break;
+            case logFile:
+              ret.logFile = argv[i];
+              break;
+            case cacheDirectory:
+              ret.cacheDirectory = argv[i];
+              break;
+            case jobCount:
+              try { ret.jobCount = std::stoi(argv[i]); }
+              catch(...) { assertThrow(false, string("Error: invalid job count \"") + argv[i] + "\""); }
+              assertThrow(static_cast<int>(ret.jobCount) >= 1, string("Error: invalid job count \"") + argv[i] + "\"");
+              break;
             case parserArgument:
               parserArgumentCache = argv[i];
               discreteArgs = splitString(parserArgumentCache, ',');
@@ -171,6 +196,12 @@ namespace lc2kicad
       VERBOSE_INFO(string("Explicitly specified config file: ") + result->configFile);
     if(result->outputDirectory.size())
       VERBOSE_INFO(string("Specified output directory: ") + result->outputDirectory);
+    if(result->logFile.size())
+      VERBOSE_INFO(string("JSON log file: ") + result->logFile);
+    if(result->cacheDirectory.size())
+      VERBOSE_INFO(string("Conversion cache directory: ") + result->cacheDirectory);
+    if(result->jobCount > 1)
+      VERBOSE_INFO(string("Conversion workers: ") + std::to_string(result->jobCount));
     if(result->parserArguments.size())
     {
       string parserArgumentsList("Specified parser arguments:\n");
@@ -202,6 +233,18 @@ namespace lc2kicad
       if(result->parserArguments.count("ENL"))
         if(result->parserArguments.at("ENL") == 1)
           Info("Extract nested libraries when using piped operation may cause problems.");
+
+      // There's only one input, so there's nothing to run in parallel
+      if(result->jobCount > 1)
+        Info("Multiple jobs are ignored when using piped operation.");
+
+      // Nor is there a file to look up in the cache
+      if(result->parserArguments.count("CACHE") && result->parserArguments.at("CACHE") != 0)
+        Info("The conversion cache is not used with piped operation.");
     }
+
+    if(result->cacheDirectory.size() &&
+       !(result->parserArguments.count("CACHE") && result->parserArguments.at("CACHE") != 0))
+      Info("A cache directory is set but the conversion cache is off. Turn it on with \"-a CACHE:1\".");
   }
 }
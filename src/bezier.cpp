@@ -1,55 +1,176 @@
-/*
-    Copyright (c) 2020 RigoLigoRLC.
-
-    This file is part of LC2KiCad.
-
-    LC2KiCad is free software: you can redistribute it and/or modify
-    it under the terms of the GNU Lesser General Public License as 
-    published by the Free Software Foundation, version 2, or version 3
-    of the License.
-
-    LC2KiCad is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU Lesser General Public License for more details.
-
-    You should have received a copy of the GNU Lesser General Public License
-    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
-*/
-
-#include "includes.hpp"
-#include "consts.hpp"
-
-using std::vector;
-
-namespace lc2kicad
-{
-  coordinates middlepoint(coordinates coord1, coordinates coord2, double t)
-  {
-    return (coord1 - coord2) * t + coord1;
-  }
-
-  /**
-   * Control points are in the order of P1 C1 ... Cn P2.
-   * At least 3 iterations are required for a proper rendering.
-   */
-  coordslist* render_bezier_curve(coordslist& control_points, int iterations)
-  {
-    if(iterations < 2)
-      throw "Invalid iterations for Bezier curve renderer.";
-
-    coordslist cp, *ret = new coordslist;
-    for(int i = 0; i < control_points.size(); i++)
-      cp[i] = control_points[i];
-    
-    double t = 0;
-    (*ret)[0] = cp[0];
-    for(int i = 1; i < iterations; i++)
-    {
-      t = double (i) / 1.0;
-      (*ret)[1] = middlepoint(cp[i], cp[i + 1], t);
-    }
-    (*ret).push_back(cp[cp.size() - 1]);
-    return ret;
-  }
-}
\ No newline at end of file
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "includes.hpp"
+#include "consts.hpp"
+#include "bezier.hpp"
+
+namespace lc2kicad
+{
+  namespace
+  {
+    /**
+     * Chords needed for a curve over t in [0, 1] whose second derivative never gets longer than
+     * secondDerivative. A chord over an interval h of t strays at most h^2 / 8 times that from the curve.
+     */
+    unsigned int chordsForCurvature(double secondDerivative, double tolerance)
+    {
+      double chords = std::ceil(std::sqrt(secondDerivative / (8.0 * tolerance)));
+      if(!(chords >= 1.0)) // Straight, or NaN from degenerate input
+        return 1;
+      return chords < maxCurveChords ? static_cast<unsigned int>(chords) : maxCurveChords;
+    }
+
+    double length(double x, double y) { return std::sqrt(x * x + y * y); }
+  }
+
+  unsigned int quadraticBezierChords(const coordinates &p0, const coordinates &p1, const coordinates &p2,
+                                     double tolerance)
+  {
+    // B''(t) = 2 (p0 - 2 p1 + p2)
+    return chordsForCurvature(2.0 * length(p0.X - 2.0 * p1.X + p2.X, p0.Y - 2.0 * p1.Y + p2.Y), tolerance);
+  }
+
+  unsigned int cubicBezierChords(const coordinates &p0, const coordinates &p1, const coordinates &p2,
+                                 const coordinates &p3, double tolerance)
+  {
+    // B''(t) = 6 ((1 - t) (p0 - 2 p1 + p2) + t (p1 - 2 p2 + p3)), so the longer of the two bounds it
+    double first = length(p0.X - 2.0 * p1.X + p2.X, p0.Y - 2.0 * p1.Y + p2.Y),
+           second = length(p1.X - 2.0 * p2.X + p3.X, p1.Y - 2.0 * p2.Y + p3.Y);
+    return chordsForCurvature(6.0 * std::max(first, second), tolerance);
+  }
+
+  unsigned int ellipticalArcChords(const centerArc &arc, double tolerance)
+  {
+    // Over t in [0, 1] the arc sweeps extent radians, so |P''(t)| <= extent^2 * the larger radius
+    double extent = toRadians(arc.angleExtend),
+           radius = std::max(std::abs(arc.size.X), std::abs(arc.size.Y)) / 2.0;
+    return chordsForCurvature(extent * extent * radius, tolerance);
+  }
+
+  void flattenQuadraticBezier(const coordinates &p0, const coordinates &p1, const coordinates &p2,
+                              unsigned int chords, double *x, double *y)
+  {
+    // B(t) = a t^2 + b t + p0
+    double h = 1.0 / chords,
+           aX = p0.X - 2.0 * p1.X + p2.X, aY = p0.Y - 2.0 * p1.Y + p2.Y,
+           bX = 2.0 * (p1.X - p0.X), bY = 2.0 * (p1.Y - p0.Y),
+           fX = p0.X, fY = p0.Y,
+           dX = aX * h * h + bX * h, dY = aY * h * h + bY * h,
+           ddX = 2.0 * aX * h * h, ddY = 2.0 * aY * h * h;
+
+    for(unsigned int i = 0; i + 1 < chords; i++)
+    {
+      fX += dX, fY += dY;
+      dX += ddX, dY += ddY;
+      x[i] = fX, y[i] = fY;
+    }
+  }
+
+  void flattenCubicBezier(const coordinates &p0, const coordinates &p1, const coordinates &p2,
+                          const coordinates &p3, unsigned int chords, double *x, double *y)
+  {
+    // B(t) = a t^3 + b t^2 + c t + p0
+    double h = 1.0 / chords, h2 = h * h, h3 = h2 * h,
+           aX = -p0.X + 3.0 * (p1.X - p2.X) + p3.X, aY = -p0.Y + 3.0 * (p1.Y - p2.Y) + p3.Y,
+           bX = 3.0 * (p0.X - 2.0 * p1.X + p2.X), bY = 3.0 * (p0.Y - 2.0 * p1.Y + p2.Y),
+           cX = 3.0 * (p1.X - p0.X), cY = 3.0 * (p1.Y - p0.Y),
+           fX = p0.X, fY = p0.Y,
+           dX = aX * h3 + bX * h2 + cX * h, dY = aY * h3 + bY * h2 + cY * h,
+           ddX = 6.0 * aX * h3 + 2.0 * bX * h2, ddY = 6.0 * aY * h3 + 2.0 * bY * h2,
+           dddX = 6.0 * aX * h3, dddY = 6.0 * aY * h3;
+
+    for(unsigned int i = 0; i + 1 < chords; i++)
+    {
+      fX += dX, fY += dY;
+      dX += ddX, dY += ddY;
+      ddX += dddX, ddY += dddY;
+      x[i] = fX, y[i] = fY;
+    }
+  }
+
+  void flattenEllipticalArc(const centerArc &arc, double XAxisRotation, unsigned int chords, double *x, double *y)
+  {
+    double rotation = toRadians(std::fmod(XAxisRotation, 360.0)),
+           cosRotation = std::cos(rotation), sinRotation = std::sin(rotation),
+           rX = arc.size.X / 2.0, rY = arc.size.Y / 2.0,
+           start = toRadians(arc.angleStart), step = toRadians(arc.angleExtend) / chords,
+           cosStep = std::cos(step), sinStep = std::sin(step),
+           u = std::cos(start), v = std::sin(start); // Point on the unit circle, turned a step at a time
+
+    for(unsigned int i = 0; i + 1 < chords; i++)
+    {
+      double turnedU = u * cosStep - v * sinStep;
+      v = u * sinStep + v * cosStep, u = turnedU;
+      x[i] = arc.center.X + cosRotation * rX * u - sinRotation * rY * v;
+      y[i] = arc.center.Y + sinRotation * rX * u + cosRotation * rY * v;
+    }
+  }
+
+  void flattenPath(const SmolSVG::pathBuffer &path, PointPool &points, double tolerance)
+  {
+    for(auto &i : path)
+    {
+      const SmolSVG::SmolCoord &start = path.startPoint(i), &end = path.endPoint(i);
+      points.append(start.X, start.Y);
+
+      unsigned int chords = 1;
+      size_t first;
+      switch(i.type)
+      {
+        case SmolSVG::QuadTo:
+          chords = quadraticBezierChords(start, path.point(i, 1), end, tolerance);
+          if(chords > 1)
+          {
+            first = points.grow(chords - 1);
+            flattenQuadraticBezier(start, path.point(i, 1), end, chords, points.dataX(first), points.dataY(first));
+          }
+          break;
+        case SmolSVG::CurveTo:
+          chords = cubicBezierChords(start, path.point(i, 1), path.point(i, 2), end, tolerance);
+          if(chords > 1)
+          {
+            first = points.grow(chords - 1);
+            flattenCubicBezier(start, path.point(i, 1), path.point(i, 2), end, chords,
+                               points.dataX(first), points.dataY(first));
+          }
+          break;
+        case SmolSVG::ArcTo:
+        {
+          const SmolSVG::SmolCoord &radii = path.radii(i);
+          if(radii.X == 0.0 || radii.Y == 0.0) // Arcs without radii are straight lines, as SVG has it
+            break;
+          centerArc arc = svgEllipticalArcComputation(start.X, start.Y, radii.X, radii.Y, i.XAxisRotation,
+                                                      i.largeArc, i.sweep, end.X, end.Y);
+          chords = ellipticalArcChords(arc, tolerance);
+          if(chords > 1)
+          {
+            first = points.grow(chords - 1);
+            flattenEllipticalArc(arc, i.XAxisRotation, chords, points.dataX(first), points.dataY(first));
+          }
+          break;
+        }
+        default:;
+      }
+    }
+  }
+}
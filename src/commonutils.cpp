@@ -32,22 +32,10 @@
 
 #include "consts.hpp"
 #include "includes.hpp"
-
-#ifdef USE_WINAPI_FOR_TEXT_COLOR
-#include <windows.h>
-#endif
+#include "numberdecoder.hpp"
 
 namespace lc2kicad
 {
-  extern programArgumentParseResult argParseResult;
-  extern long errorCount, warningCount;
-  extern std::ostream *logstream;
-#ifdef USE_WINAPI_FOR_TEXT_COLOR
-  extern HANDLE hStdOut;
-  extern CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
-  extern WORD wBackgroundColor;
-#endif
-  
   void assertThrow(const bool statement, const char* message) {if(!statement){throw std::runtime_error(message);}}
   void assertThrow(const bool statement, const std::string &message) {if(!statement){throw std::runtime_error(message.c_str());}}
 
@@ -101,13 +89,50 @@ namespace lc2kicad
     return res;
   }
 
-  std::string loadNthSeparated(std::string &s, char delimiter, unsigned int nth)
+  void splitByString(const fieldView &s, const fieldView &delimiter, std::vector<fieldView> &result)
   {
-    std::stringstream ss(s);
-    std::string ret;
-    for(unsigned int i = 0; i <= nth; i++)
-      std::getline(ss, ret, delimiter);
-    return ret;
+    const char *cursor = s.begin(), *candidate = cursor, *last = s.end();
+    result.clear();
+
+    // Look for the first delimiter character with the delimiter scanner, then verify the rest
+    while(static_cast<size_t>(last - candidate) >= delimiter.size())
+    {
+      candidate = findDelimiter(candidate, last, delimiter[0]);
+      if(static_cast<size_t>(last - candidate) < delimiter.size())
+        break;
+      if(!std::memcmp(candidate, delimiter.data(), delimiter.size()))
+      {
+        result.emplace_back(cursor, candidate - cursor);
+        candidate = cursor = candidate + delimiter.size();
+      }
+      else
+        candidate++;
+    }
+
+    result.emplace_back(cursor, last - cursor);
+  }
+
+  // Split at the first delimiter only. Returns false, with the whole string as head, if there's none.
+  bool splitFirstByString(const fieldView &s, const fieldView &delimiter, fieldView &head, fieldView &rest)
+  {
+    const char *candidate = s.begin(), *last = s.end();
+
+    while(static_cast<size_t>(last - candidate) >= delimiter.size())
+    {
+      candidate = findDelimiter(candidate, last, delimiter[0]);
+      if(static_cast<size_t>(last - candidate) < delimiter.size())
+        break;
+      if(!std::memcmp(candidate, delimiter.data(), delimiter.size()))
+      {
+        head = fieldView(s.begin(), candidate - s.begin());
+        rest = fieldView(candidate + delimiter.size(), last - candidate - delimiter.size());
+        return true;
+      }
+      candidate++;
+    }
+
+    head = s, rest = fieldView();
+    return false;
   }
 
   void sanitizeFileName(std::string &filename)
@@ -133,20 +158,20 @@ namespace lc2kicad
     return ret;
   }
 
-  int tolStoi(const std::string &c1, const int fail)
+  /**
+   * Numeric conversion straight from a field, see decodeNumber. Empty fields and fields that
+   * don't start with a number give the fail value instead of throwing like std::stoi.
+   */
+  int tolStoi(const fieldView &c1, const int fail)
   {
-    if(c1.size())
-      return std::stoi(c1);
-    else
-      return fail;
+    int ret;
+    return decodeNumber(c1.begin(), c1.end(), ret).error == numberError::none ? ret : fail;
   }
 
-  double tolStod(const std::string &c1, const double fail)
+  double tolStod(const fieldView &c1, const double fail)
   {
-    if(c1.size())
-      return std::stod(c1);
-    else
-      return fail;
+    double ret;
+    return decodeNumber(c1.begin(), c1.end(), ret).error == numberError::none ? ret : fail;
   }
 
   bool fuzzyCompare(const double a, const double b)
@@ -243,51 +268,96 @@ namespace lc2kicad
     //
     return { { cx, cy }, { rx * 2.0, ry * 2.0 }, angleStart, angleExtent };
   }
-  
-  void Error(std::string s)
-  {
-#ifdef USE_WINAPI_FOR_TEXT_COLOR
-    GetConsoleScreenBufferInfo(hStdOut, &consoleInfo);
-    wBackgroundColor = consoleInfo.wAttributes & (BACKGROUND_RED | BACKGROUND_GREEN | BACKGROUND_BLUE | BACKGROUND_INTENSITY );
-    SetConsoleTextAttribute(hStdOut, FOREGROUND_RED | FOREGROUND_INTENSITY | wBackgroundColor);
-    *logstream << "Error: " << s << std::endl;
-    SetConsoleTextAttribute(hStdOut, consoleInfo.wAttributes);
-#else
-    *logstream << "\033[1;31mError: " << s << "\033[39m\n";
-#endif
-    errorCount++;
-  }
 
-  void Warn(std::string s)
+  size_t svgArcBatch::add(double x0, double y0, double rx, double ry, double angle, bool largeArcFlag, bool sweepFlag,
+                          double x, double y)
   {
-#ifdef USE_WINAPI_FOR_TEXT_COLOR
-    GetConsoleScreenBufferInfo(hStdOut, &consoleInfo);
-    wBackgroundColor = consoleInfo.wAttributes & (BACKGROUND_RED | BACKGROUND_GREEN | BACKGROUND_BLUE | BACKGROUND_INTENSITY );
-    SetConsoleTextAttribute(hStdOut, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY | wBackgroundColor);
-    *logstream << "Warning: " << s << std::endl;
-    SetConsoleTextAttribute(hStdOut, consoleInfo.wAttributes);
-#else
-    *logstream << "\033[1;93mWarning: " << s << "\033[39m\n";
-#endif
-    warningCount++;
+    startX.push_back(x0), startY.push_back(y0), radiusX.push_back(rx), radiusY.push_back(ry);
+    rotation.push_back(angle), largeArc.push_back(largeArcFlag), sweep.push_back(sweepFlag);
+    endX.push_back(x), endY.push_back(y);
+    return startX.size() - 1;
   }
 
-  void Info(std::string s)
+  void svgArcBatch::clear()
   {
-#ifdef USE_WINAPI_FOR_TEXT_COLOR
-    GetConsoleScreenBufferInfo(hStdOut, &consoleInfo);
-    wBackgroundColor = consoleInfo.wAttributes & (BACKGROUND_RED | BACKGROUND_GREEN | BACKGROUND_BLUE | BACKGROUND_INTENSITY );
-    SetConsoleTextAttribute(hStdOut, FOREGROUND_BLUE | FOREGROUND_INTENSITY | wBackgroundColor);
-    *logstream << "Info: " << s << std::endl;
-    SetConsoleTextAttribute(hStdOut, consoleInfo.wAttributes);
-#else
-    *logstream << "\033[1;96mInfo: " << s << "\033[39m\n";
-#endif
+    for(auto i : { &startX, &startY, &radiusX, &radiusY, &rotation, &endX, &endY,
+                   &centerX, &centerY, &sizeX, &sizeY, &angleStart, &angleExtend })
+      i->clear();
+    largeArc.clear(), sweep.clear();
   }
 
-  void InfoVerbose(std::function<std::string()> sf)
+  void svgEllipticalArcComputation(svgArcBatch &batch)
   {
-    if(!argParseResult.verboseInfo) return;
-    Info(sf());
+    // The same steps as above, each done across the whole batch before the next. The steps calling into the
+    // math library are kept apart from the arithmetic ones, which go over plain arrays with no branches
+    // and can be vectorized by the compiler. Every arc gets the exact same result as from the function above.
+    const size_t count = batch.size();
+    const double *x0 = batch.startX.data(), *y0 = batch.startY.data(), *x = batch.endX.data(),
+                 *y = batch.endY.data(), *radiusX = batch.radiusX.data(), *radiusY = batch.radiusY.data();
+    const char *largeArcFlag = batch.largeArc.data(), *sweepFlag = batch.sweep.data();
+    std::vector<double> cosAngle(count), sinAngle(count), startSign(count), extentSign(count);
+    for(auto i : { &batch.centerX, &batch.centerY, &batch.sizeX, &batch.sizeY, &batch.angleStart, &batch.angleExtend })
+      i->resize(count);
+    double *cx = batch.centerX.data(), *cy = batch.centerY.data(), *sizeX = batch.sizeX.data(),
+           *sizeY = batch.sizeY.data(), *angleStart = batch.angleStart.data(), *angleExtent = batch.angleExtend.data();
+
+    for(size_t i = 0; i < count; i++)
+    {
+      double angle = toRadians(std::fmod(batch.rotation[i], 360.0));
+      cosAngle[i] = std::cos(angle), sinAngle[i] = std::sin(angle);
+    }
+
+    // Steps 1 to 3, and step 4 up to the cosines of the angles, which go into angleStart and angleExtent
+    for(size_t i = 0; i < count; i++)
+    {
+      double dx2 = (x0[i] - x[i]) / 2.0,
+             dy2 = (y0[i] - y[i]) / 2.0,
+             x1 = cosAngle[i] * dx2 + sinAngle[i] * dy2,
+             y1 = -sinAngle[i] * dx2 + cosAngle[i] * dy2,
+             rx = std::abs(radiusX[i]),
+             ry = std::abs(radiusY[i]),
+             Px1 = x1 * x1,
+             Py1 = y1 * y1,
+             radiiCheck = Px1 / (rx * rx) + Py1 / (ry * ry),
+             scale = radiiCheck > 1 ? std::sqrt(radiiCheck) : 1.0;
+      rx = scale * rx;
+      ry = scale * ry;
+      double Prx = rx * rx,
+             Pry = ry * ry,
+             sign = largeArcFlag[i] == sweepFlag[i] ? -1.0 : 1.0,
+             sq = (Prx * Pry - Prx * Py1 - Pry * Px1) / (Prx * Py1 + Pry * Px1);
+      sq = sq < 0 ? 0 : sq;
+      double coef = sign * std::sqrt(sq),
+             cx1 = coef * ((rx * y1) / ry),
+             cy1 = coef * -((ry * x1) / rx),
+             ux = (x1 - cx1) / rx,
+             uy = (y1 - cy1) / ry,
+             vx = (-x1 - cx1) / rx,
+             vy = (-y1 - cy1) / ry;
+      cx[i] = (x0[i] + x[i]) / 2.0 + (cosAngle[i] * cx1 - sinAngle[i] * cy1);
+      cy[i] = (y0[i] + y[i]) / 2.0 + (sinAngle[i] * cx1 + cosAngle[i] * cy1);
+      sizeX[i] = rx * 2.0, sizeY[i] = ry * 2.0;
+      angleStart[i] = ux / std::sqrt(ux * ux + uy * uy);
+      startSign[i] = uy < 0 ? -1.0 : 1.0;
+      angleExtent[i] = (ux * vx + uy * vy) / std::sqrt((ux * ux + uy * uy) * (vx * vx + vy * vy));
+      extentSign[i] = ux * vy - uy * vx < 0 ? -1.0 : 1.0;
+    }
+
+    for(size_t i = 0; i < count; i++)
+      angleStart[i] = std::acos(angleStart[i]), angleExtent[i] = std::acos(angleExtent[i]);
+
+    for(size_t i = 0; i < count; i++)
+    {
+      double extent = toDegrees(extentSign[i] * angleExtent[i]);
+      if(!sweepFlag[i] && extent > 0)
+        extent -= 360;
+      else if(sweepFlag[i] && extent < 0)
+        extent += 360;
+      angleExtent[i] = std::fmod(extent, 360.0);
+      angleStart[i] = std::fmod(toDegrees(startSign[i] * angleStart[i]), 360.0);
+
+      if(fuzzyCompare(x0[i], x[i]) && fuzzyCompare(y0[i], y[i])) // Start and end coincide
+        cx[i] = x0[i], cy[i] = y0[i], sizeX[i] = sizeY[i] = 0, angleStart[i] = 0, angleExtent[i] = 360;
+    }
   }
 }
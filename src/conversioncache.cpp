@@ -0,0 +1,279 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+
+#include "consts.hpp"
+#include "includes.hpp"
+#include "sha256.hpp"
+#include "conversioncache.hpp"
+
+#ifdef _WIN32
+  #include <windows.h>
+  #include <direct.h>
+  #include <sys/utime.h>
+#else
+  #include <sys/stat.h>
+  #include <sys/types.h>
+  #include <dirent.h>
+  #include <unistd.h>
+  #include <utime.h>
+#endif
+
+using std::string;
+using std::vector;
+using std::to_string;
+
+namespace lc2kicad
+{
+  /**
+   * Entries are only good for the output of the converter that made them, and SOFTWARE_VERSION isn't bumped
+   * often enough to tell. cacheOutputRevision goes into every key: bump it with any change to what gets written
+   * for the same input and arguments (formatting, net codes, geometry, file names), so entries made before it are
+   * never hit again. cacheEntryMagic is the layout of entry files, and only changes with load() and store().
+   */
+  static const unsigned int cacheOutputRevision = 1;
+  static const char cacheEntryMagic[] = "LC2KiCad conversion cache 1\n";
+  static const char cacheEntryExtension[] = ".lcc";
+
+  ConversionCache::ConversionCache(const string &directory, unsigned long long sizeLimit,
+                                   const str_dbl_map &parserArguments)
+    : directory(directory), sizeLimit(sizeLimit), parserArguments(parserArguments)
+  {
+    if(!this->directory.empty() && this->directory.back() != '/' && this->directory.back() != '\\')
+      this->directory += '/';
+
+    // Create the directory and whatever it's in, one level at a time
+    for(size_t i = 1; i <= this->directory.size(); i++)
+      if(i == this->directory.size() || this->directory[i] == '/' || this->directory[i] == '\\')
+      {
+        string level = this->directory.substr(0, i);
+#ifdef _WIN32
+        _mkdir(level.c_str());
+#else
+        mkdir(level.c_str(), 0777);
+#endif
+      }
+  }
+
+  string ConversionCache::defaultDirectory()
+  {
+#ifdef _WIN32
+    if(const char *localAppData = std::getenv("LOCALAPPDATA"))
+      return string(localAppData) + "\\lc2kicad\\cache";
+#else
+    if(const char *cacheHome = std::getenv("XDG_CACHE_HOME"))
+      if(*cacheHome)
+        return string(cacheHome) + "/lc2kicad";
+    if(const char *home = std::getenv("HOME"))
+      return string(home) + "/.cache/lc2kicad";
+#endif
+    return "lc2kicad-cache";
+  }
+
+  string ConversionCache::entryPath(const string &key) const { return directory + key + cacheEntryExtension; }
+
+  // The cache switches themselves don't change what gets written, so they stay out of the key.
+  string ConversionCache::makeKey(const string &inputName, const char *input, size_t length) const
+  {
+    SHA256 hash;
+    hash.update(string(cacheEntryMagic) + SOFTWARE_VERSION + '\n' + to_string(cacheOutputRevision) + '\n');
+    for(auto &i : parserArguments)
+      if(i.first != "CACHE" && i.first != "CACHESIZE")
+        hash.update(i.first + '=' + to_string(i.second) + '\n');
+    hash.update(inputName + '\n');
+    hash.update(input, length);
+    return hash.hexDigest();
+  }
+
+  /**
+   * Entry layout: the magic line, the file count on a line, then for each file a line with the lengths of
+   * its name and content, followed by the name and the content as they are.
+   */
+  bool ConversionCache::load(const string &key, vector<outputFile> &outputs)
+  {
+    string path = entryPath(key);
+    std::ifstream entry(path, std::ios::in | std::ios::binary);
+    string magic(sizeof(cacheEntryMagic) - 1, '\0');
+    size_t fileCount = 0, entrySize = 0;
+
+    outputs.clear();
+    if(entry.seekg(0, std::ios::end))
+      entrySize = static_cast<size_t>(entry.tellg());
+    entry.seekg(0);
+    if(entry && entry.read(&magic[0], magic.size()) && magic == cacheEntryMagic && entry >> fileCount &&
+       entry.get() == '\n')
+      for(size_t i = 0; i < fileCount; i++)
+      {
+        size_t nameLength, contentLength;
+        if(!(entry >> nameLength >> contentLength) || entry.get() != '\n' ||
+           nameLength > entrySize || contentLength > entrySize) // Don't trust lengths from a damaged entry
+          break;
+        outputs.emplace_back();
+        outputs.back().name.resize(nameLength);
+        outputs.back().content.resize(contentLength);
+        if(!entry.read(&outputs.back().name[0], nameLength) || !entry.read(&outputs.back().content[0], contentLength))
+          break;
+      }
+
+    if(!entry || outputs.size() != fileCount || !fileCount)
+    {
+      if(entry.is_open())
+        VERBOSE_INFO("[Cache] Entry " + key + " is unreadable and ignored.");
+      outputs.clear();
+      misses++;
+      return false;
+    }
+
+    // Count as recently used for eviction
+#ifdef _WIN32
+    _utime(path.c_str(), nullptr);
+#else
+    utime(path.c_str(), nullptr);
+#endif
+    hits++;
+    return true;
+  }
+
+  void ConversionCache::store(const string &key, const vector<outputFile> &outputs)
+  {
+#ifdef _WIN32
+    unsigned long processId = GetCurrentProcessId();
+#else
+    unsigned long processId = static_cast<unsigned long>(getpid());
+#endif
+    string path = entryPath(key),
+           temporaryPath = path + '.' + to_string(processId) + '.' + to_string(temporaryCounter++) + ".tmp";
+
+    {
+      std::ofstream entry(temporaryPath, std::ios::out | std::ios::binary);
+      entry << cacheEntryMagic << outputs.size() << '\n';
+      for(auto &i : outputs)
+        entry << i.name.size() << ' ' << i.content.size() << '\n' << i.name << i.content;
+      entry.flush();
+      if(!entry)
+      {
+        entry.close();
+        std::remove(temporaryPath.c_str());
+        VERBOSE_INFO("[Cache] Cannot write entry " + key + " into \"" + directory + "\".");
+        return;
+      }
+    }
+
+    // Publish the entry in one step. If another process got there first, its entry is just as good.
+#ifdef _WIN32
+    bool published = MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    bool published = !std::rename(temporaryPath.c_str(), path.c_str());
+#endif
+    if(!published)
+      std::remove(temporaryPath.c_str());
+    else
+      stores++;
+  }
+
+  bool ConversionCache::claimOutput(const string &path, const string &input)
+  {
+    std::lock_guard<std::mutex> lock(outputWritersMutex);
+    auto writer = outputWriters.emplace(path, input).first;
+    if(writer->second == input)
+      return true;
+    VERBOSE_INFO("[Cache] \"" + path + "\" was also written for \"" + writer->second + "\"; \"" + input +
+                 "\" is not recorded.");
+    return false;
+  }
+
+  void ConversionCache::trim()
+  {
+    struct entryInfo
+    {
+      string path;
+      unsigned long long size;
+      time_t lastUsed;
+    };
+    vector<entryInfo> entries;
+    unsigned long long totalSize = 0;
+    time_t now = std::time(nullptr);
+
+    auto visit = [&](const string &name, unsigned long long size, time_t lastUsed)
+    {
+      size_t extensionLength = sizeof(cacheEntryExtension) - 1;
+      if(name.size() > extensionLength && !name.compare(name.size() - extensionLength, extensionLength, cacheEntryExtension))
+      {
+        entries.push_back({ directory + name, size, lastUsed });
+        totalSize += size;
+      }
+      else if(name.size() > 4 && !name.compare(name.size() - 4, 4, ".tmp") && now - lastUsed > 3600)
+        std::remove((directory + name).c_str()); // Left behind by a process that didn't get to finish
+    };
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA((directory + "*").c_str(), &found);
+    if(search != INVALID_HANDLE_VALUE)
+    {
+      do
+      {
+        ULARGE_INTEGER writeTime;
+        writeTime.LowPart = found.ftLastWriteTime.dwLowDateTime, writeTime.HighPart = found.ftLastWriteTime.dwHighDateTime;
+        time_t lastUsed = static_cast<time_t>((writeTime.QuadPart - 116444736000000000ull) / 10000000); // FILETIME epoch
+        visit(found.cFileName, (static_cast<unsigned long long>(found.nFileSizeHigh) << 32) | found.nFileSizeLow, lastUsed);
+      }
+      while(FindNextFileA(search, &found));
+      FindClose(search);
+    }
+#else
+    if(DIR *listing = opendir(directory.c_str()))
+    {
+      while(dirent *found = readdir(listing))
+      {
+        struct stat entryStat;
+        if(!stat((directory + found->d_name).c_str(), &entryStat) && S_ISREG(entryStat.st_mode))
+          visit(found->d_name, static_cast<unsigned long long>(entryStat.st_size), entryStat.st_mtime);
+      }
+      closedir(listing);
+    }
+#endif
+
+    if(totalSize <= sizeLimit)
+      return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const entryInfo &a, const entryInfo &b) { return a.lastUsed < b.lastUsed; });
+    for(auto &i : entries)
+    {
+      if(totalSize <= sizeLimit)
+        break;
+      if(!std::remove(i.path.c_str()))
+        evictions++;
+      totalSize -= i.size; // Gone, or in use by someone else who will deal with it
+    }
+  }
+
+  void ConversionCache::reportStatistics() const
+  {
+    Info("Conversion cache: " + to_string(hits) + " hit(s), " + to_string(misses) + " miss(es), " +
+         to_string(stores) + " stored, " + to_string(evictions) + " evicted.");
+  }
+}
@@ -0,0 +1,99 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#include "includes.hpp"
+#include "edaclasses.hpp"
+#include "lc2kicadcore.hpp"
+#include "conversionpool.hpp"
+#include "logger.hpp"
+
+using std::string;
+using std::vector;
+
+namespace lc2kicad
+{
+  ConversionPool::ConversionPool(const str_dbl_map &parserArguments, unsigned int workerCount, ConversionCache *cache)
+    : coreParserArguments(parserArguments), workerCount(workerCount ? workerCount : 1), cache(cache) { }
+
+  void ConversionPool::convertFiles(const stringlist &filenames, string &outputPath)
+  {
+    std::atomic<size_t> nextFile(0);
+
+    auto worker = [&]()
+    {
+      str_dbl_map arguments = coreParserArguments; // LC2KiCadCore takes a mutable map
+      LC2KiCadCore core(arguments);
+      core.setConversionCache(cache);
+
+      for(size_t index; (index = nextFile++) < filenames.size(); )
+      {
+        string filename = filenames[index];
+        list<EDADocument*> docList;
+
+        if(cache)
+        {
+          try { core.convertFileCached(filename, outputPath); }
+          catch(std::runtime_error &e)
+          {
+            Error(string("Parsing for \"") + filename + "\" failed with exception: " + e.what());
+          }
+          flushLog();
+          continue;
+        }
+
+        try
+        {
+          docList = core.autoParseLCFile(filename);
+        }
+        catch(std::runtime_error &e)
+        {
+          Error(string("Parsing for \"") + filename + "\" failed with exception: " + e.what());
+          continue;
+        }
+
+        // Write and free the documents of this file before taking the next one.
+        for(auto &i : docList)
+          if(i)
+          {
+            try { core.deserializeFile(i, &outputPath); }
+            catch(std::exception &e)
+            {
+              Error(string("Writing a document of \"") + filename + "\" failed with exception: " + e.what());
+            }
+            delete i;
+          }
+        flushLog();
+      }
+    };
+
+    unsigned int threadCount = static_cast<unsigned int>(std::min<size_t>(workerCount, filenames.size()));
+    vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for(unsigned int i = 0; i < threadCount; i++)
+      threads.emplace_back(worker);
+    for(auto &i : threads)
+      i.join();
+  }
+}
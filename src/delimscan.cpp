@@ -0,0 +1,203 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "delimscan.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define LC2KICAD_X86_SIMD
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #endif
+#endif
+
+// GCC and Clang need the instruction set enabled per function, MSVC always accepts the intrinsics.
+#if defined(LC2KICAD_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+  #define LC2KICAD_TARGET(isa) __attribute__((target(isa)))
+#else
+  #define LC2KICAD_TARGET(isa)
+#endif
+
+namespace lc2kicad
+{
+  namespace
+  {
+    typedef size_t (*scannerFunction)(const char*, const char*, char, char, const char**, size_t);
+
+    size_t scanScalar(const char *first, const char *last, char delimiterA, char delimiterB,
+                      const char **found, size_t capacity)
+    {
+      size_t count = 0;
+      for(const char *i = first; i < last && count < capacity; i++)
+        if(*i == delimiterA || *i == delimiterB)
+          found[count++] = i;
+      return count;
+    }
+
+#ifdef LC2KICAD_X86_SIMD
+    inline unsigned lowestSetBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return index;
+#else
+      return __builtin_ctz(mask);
+#endif
+    }
+
+    // Turn one compare mask into positions. Returns false once found is full.
+    inline bool collectMatches(unsigned mask, const char *block, const char **found, size_t &count, size_t capacity)
+    {
+      while(mask)
+      {
+        if(count == capacity)
+          return false;
+        found[count++] = block + lowestSetBit(mask);
+        mask &= mask - 1;
+      }
+      return true;
+    }
+
+    LC2KICAD_TARGET("sse2")
+    size_t scanSSE2(const char *first, const char *last, char delimiterA, char delimiterB,
+                    const char **found, size_t capacity)
+    {
+      const __m128i matchA = _mm_set1_epi8(delimiterA), matchB = _mm_set1_epi8(delimiterB);
+      const char *block = first;
+      size_t count = 0;
+
+      for(; last - block >= 16; block += 16)
+      {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                          _mm_or_si128(_mm_cmpeq_epi8(chunk, matchA), _mm_cmpeq_epi8(chunk, matchB))));
+        if(!collectMatches(mask, block, found, count, capacity))
+          return count;
+      }
+
+      // Tail: reload the last 16 bytes of the range and drop the ones already looked at
+      if(block < last && last - first >= 16)
+      {
+        unsigned remaining = static_cast<unsigned>(last - block);
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(last - 16));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                          _mm_or_si128(_mm_cmpeq_epi8(chunk, matchA), _mm_cmpeq_epi8(chunk, matchB))));
+        collectMatches(mask >> (16 - remaining), block, found, count, capacity);
+        return count;
+      }
+
+      return count + scanScalar(block, last, delimiterA, delimiterB, found + count, capacity - count);
+    }
+
+    LC2KICAD_TARGET("avx2")
+    size_t scanAVX2(const char *first, const char *last, char delimiterA, char delimiterB,
+                    const char **found, size_t capacity)
+    {
+      const __m256i matchA = _mm256_set1_epi8(delimiterA), matchB = _mm256_set1_epi8(delimiterB);
+      const char *block = first;
+      size_t count = 0;
+
+      for(; last - block >= 32; block += 32)
+      {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+                          _mm256_or_si256(_mm256_cmpeq_epi8(chunk, matchA), _mm256_cmpeq_epi8(chunk, matchB))));
+        if(!collectMatches(mask, block, found, count, capacity))
+          return count;
+      }
+
+      // Tail: reload the last 32 bytes of the range and drop the ones already looked at
+      if(block < last && last - first >= 32)
+      {
+        unsigned remaining = static_cast<unsigned>(last - block);
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(last - 32));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+                          _mm256_or_si256(_mm256_cmpeq_epi8(chunk, matchA), _mm256_cmpeq_epi8(chunk, matchB))));
+        collectMatches(mask >> (32 - remaining), block, found, count, capacity);
+        return count;
+      }
+
+      return count + scanSSE2(block, last, delimiterA, delimiterB, found + count, capacity - count);
+    }
+
+    bool cpuHasAVX2()
+    {
+#ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 0);
+      if(info[0] < 7)
+        return false;
+      __cpuid(info, 1);
+      bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6; // OSXSAVE, then XMM and YMM state
+      __cpuidex(info, 7, 0);
+      return osSavesYmm && (info[1] & (1 << 5));
+#else
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    bool cpuHasSSE2()
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+      return true; // Part of x86-64 baseline
+#elif defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 1);
+      return info[3] & (1 << 26);
+#else
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2");
+#endif
+    }
+#endif
+
+    struct scannerChoice
+    {
+      scannerFunction function;
+      const char *name;
+    };
+
+    scannerChoice chooseScanner()
+    {
+#ifdef LC2KICAD_X86_SIMD
+      if(cpuHasAVX2())
+        return { scanAVX2, "AVX2" };
+      if(cpuHasSSE2())
+        return { scanSSE2, "SSE2" };
+#endif
+      return { scanScalar, "scalar" };
+    }
+
+    const scannerChoice& activeScanner()
+    {
+      static const scannerChoice choice = chooseScanner();
+      return choice;
+    }
+  }
+
+  size_t scanDelimiters(const char *first, const char *last, char delimiterA, char delimiterB,
+                        const char **found, size_t capacity)
+  {
+    return activeScanner().function(first, last, delimiterA, delimiterB, found, capacity);
+  }
+
+  const char* activeDelimiterScanner() { return activeScanner().name; }
+}
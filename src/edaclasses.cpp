@@ -27,6 +27,7 @@
 #include "lc2kicadcore.hpp"
 #include "rapidjson.hpp"
 #include "edaclasses.hpp"
+#include "outputbuffer.hpp"
 
 using std::vector;
 using std::fstream;
@@ -68,7 +69,9 @@ namespace lc2kicad
     pathToFile = a.pathToFile;
     docInfo = a.docInfo;
     module = a.module;
+    inputBuffer = a.inputBuffer;
     jsonParseResult = a.jsonParseResult;
+    jsonObject = a.jsonObject;
   }
   
   void PCBDocument::addElement(EDAElement* element)
@@ -81,10 +84,27 @@ namespace lc2kicad
 
   PCBDocument::~PCBDocument() //Destructor
   {
-    if(containedElements.size() != 0) //Free memory taken up by elements contained in the document
-      for(auto i : containedElements) //Iterate through the vector
-        if(i) //If it's not a NULL or nullptr
-          delete i, i = nullptr;
+    // Elements are freed along with elementArena
+  }
+
+  void PCBDocument::resolveParsedShapes()
+  {
+    pointPool.transform();
+
+    if(!pendingArcs.size())
+      return;
+    svgEllipticalArcComputation(pendingArcs);
+    for(size_t i = 0; i < pendingArcs.size(); i++)
+    {
+      PCB_GraphicalArc *arc = pendingArcElements[i].first;
+      coordinates origin = pendingArcElements[i].second;
+      coordinates start(pendingArcs.startX[i], pendingArcs.startY[i]), end(pendingArcs.endX[i], pendingArcs.endY[i]);
+      arc->center = (coordinates(pendingArcs.centerX[i], pendingArcs.centerY[i]) - origin) * tenmils_to_mm_coefficient;
+      arc->angle = std::abs(pendingArcs.angleExtend[i]);
+      arc->endPoint = ((pendingArcs.sweep[i] ? start : end) - origin) * tenmils_to_mm_coefficient;
+    }
+    pendingArcs.clear();
+    pendingArcElements.clear();
   }
   
   SchematicDocument::SchematicDocument(const EDADocument& a)// : EDADocument::EDADocument(true)
@@ -92,52 +112,52 @@ namespace lc2kicad
     pathToFile = a.pathToFile;
     docInfo = a.docInfo;
     module = a.module;
+    inputBuffer = a.inputBuffer;
     jsonParseResult = a.jsonParseResult;
+    jsonObject = a.jsonObject;
   }
 
   SchematicDocument::~SchematicDocument() //Destructor
   {
-    if(containedElements.size() != 0) //Free memory taken up by elements contained in the document
-      for(auto i : containedElements) //Iterate through the vector
-        if(i) //If it's not a NULL or nullptr
-          delete i, i = nullptr;
+    // Elements are freed along with elementArena
+  }
+
+  unsigned int PCBNetManager::obtainNetCode(const std::string &netName)
+  {
+    auto found = netCodeByName.find(netName);
+    if(found != netCodeByName.end())
+      return found->second;
+
+    unsigned int code = static_cast<unsigned int>(netNames.size());
+    rawNetNames.push_back(&netCodeByName.emplace(netName, code).first->first);
+    netNames.push_back(escapeQuotedString(netName));
+    return code;
   }
 
-  unsigned int PCBNetManager::obtainNetCode(std::string &netName)
+  PCBNet PCBNetManager::importNet(const PCBNetManager &other, PCBNet net)
   {
-    for(auto &it : netNameCodeMap)
-      if(it.second == netName)
-        return it.first;
-    netNameCodeMap[netNameCodeMap.size()] = netName;
-    return netNameCodeMap.size() - 1;
+    return obtainNetCode(*other.rawNetNames[net]);
   }
 
-  void PCBNetManager::setNet(std::string &netName, PCBNet &net)
+  void PCBNetManager::setNet(const std::string &netName, PCBNet &net)
   {
-    auto cleanNetName = escapeQuotedString(netName);
-    net.first = obtainNetCode(cleanNetName);
-    net.second = cleanNetName;
+    net = obtainNetCode(netName);
   }
 
-  bool PCBNetManager::findNet(std::string &netName)
+  bool PCBNetManager::findNet(const std::string &netName) const
   {
-    for(auto it = netNameCodeMap.begin(); it != netNameCodeMap.end(); it++)
-      if(it->second == netName)
-        return true;
-    return false;
+    return netCodeByName.count(netName) != 0;
   }
 
-  std::string PCBNetManager::outputPCBNetInfo()
+  void PCBNetManager::outputPCBNetInfo(OutputBuffer &out) const
   {
-    string ret;
-    for(auto &i : netNameCodeMap)
-      ret += "  (net " + std::to_string(i.first) + " \"" + i.second + "\")\n";
-    return ret;
+    for(unsigned int i = 0; i < netNames.size(); i++)
+      out << "  (net " << i << " \"" << netNames[i] << "\")\n";
   }
 
   PCBNetManager::PCBNetManager()
   {
-    netNameCodeMap[0] = "";
+    obtainNetCode("");
   }
 
   void PCBFloodFillPriorityManager::logPriority(unsigned int easyedaFillPriority)
@@ -147,35 +167,13 @@ namespace lc2kicad
                  ", current maximum priority " + std::to_string(maximumPriority));
   }
 
+  void PCBFloodFillPriorityManager::merge(const PCBFloodFillPriorityManager &other)
+  {
+    if(other.maximumPriority > maximumPriority) maximumPriority = other.maximumPriority;
+  }
+
   unsigned int PCBFloodFillPriorityManager::getKiCadPriority(unsigned int easyedaFillPriority)
   {
     return easyedaFillPriority ? maximumPriority + 1 - easyedaFillPriority : 0; // 0 was reserved for solid regions
   }
-  
-  string* PCB_Module::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBModule(*this); }
-  string* PCB_Pad::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBPad(*this); }
-  string* PCB_GraphicalTrack::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBGraphicalTrack(*this); }
-  string* PCB_CopperTrack::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBCopperTrack(*this); }
-  string* PCB_Hole::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBHole(*this); }
-  string* PCB_Via::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBVia(*this); }
-  string* PCB_CopperSolidRegion::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBCopperSolidRegion(*this); }
-  string* PCB_GraphicalSolidRegion::deserializeSelf(KiCad_5_Deserializer &deserializer) const { return deserializer.outputPCBGraphicalSolidRegion(*this); }
-  string* PCB_FloodFill::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBFloodFill(*this); }
-  string* PCB_KeepoutRegion::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBKeepoutRegion(*this); }
-  string* PCB_GraphicalCircle::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBGraphicalCircle(*this); }
-  string* PCB_CopperCircle::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBCopperCircle(*this); }
-  string* PCB_Rect::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBRect(*this); }
-  string* PCB_GraphicalArc::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBGraphicalArc(*this); }
-
-  string* PCB_CopperArc::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBCopperArc(*this); }
-  string* PCB_Text::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputPCBText(*this); }
-  string* Schematic_Module::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputSchModule(*this); }
-  string* Schematic_Pin::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputSchPin(*this); }
-  string* Schematic_Polyline::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputSchPolyline(*this); }
-  string* Schematic_Rect::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputSchRect(*this); }
-  string* Schematic_Polygon::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputSchPolygon(*this); }
-
-  string* Schematic_Arc::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputSchArc(*this); }
-
-  string* Schematic_Text::deserializeSelf(KiCad_5_Deserializer& deserializer) const { return deserializer.outputSchText(*this); }
 }
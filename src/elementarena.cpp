@@ -0,0 +1,87 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <cstdlib>
+
+#include "elementarena.hpp"
+
+namespace lc2kicad
+{
+  thread_local ElementArena *ElementArena::constructingArena = nullptr;
+
+  ElementArena::ElementArena(size_t blockSize) : blockSize(blockSize) { }
+
+  ElementArena::~ElementArena() { release(); }
+
+  static char* alignUp(char *pointer, size_t alignment)
+  {
+    size_t address = reinterpret_cast<size_t>(pointer);
+    return pointer + (alignment - address % alignment) % alignment;
+  }
+
+  void* ElementArena::allocate(size_t size, size_t alignment)
+  {
+    inUse += size;
+    if(inUse > peak)
+      peak = inUse;
+
+    // Large requests (long point lists) get a block of their own, so the current block isn't abandoned
+    if(size > blockSize / 4)
+      return alignUp(reinterpret_cast<char*>(newBlock(size + alignment, false) + 1), alignment);
+
+    char *ret = cursor ? alignUp(cursor, alignment) : nullptr;
+    if(!ret || ret > limit || size > static_cast<size_t>(limit - ret))
+      ret = alignUp(reinterpret_cast<char*>(newBlock(blockSize, true) + 1), alignment);
+    cursor = ret + size;
+    return ret;
+  }
+
+  ElementArena::block* ElementArena::newBlock(size_t payloadSize, bool makeCurrent)
+  {
+    block *ret = static_cast<block*>(std::malloc(sizeof(block) + payloadSize));
+    if(!ret)
+      throw std::bad_alloc();
+
+    ret->next = blocks;
+    blocks = ret;
+    if(makeCurrent)
+    {
+      cursor = reinterpret_cast<char*>(ret + 1);
+      limit = cursor + payloadSize;
+    }
+    return ret;
+  }
+
+  void ElementArena::release()
+  {
+    for(destructorNode *i = destructors; i; i = i->next) // Newest first
+      i->destroy(i->object);
+    destructors = nullptr;
+
+    while(blocks)
+    {
+      block *next = blocks->next;
+      std::free(blocks);
+      blocks = next;
+    }
+    cursor = limit = nullptr;
+    inUse = 0;
+  }
+}
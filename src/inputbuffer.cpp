@@ -0,0 +1,126 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <iterator>
+
+#include "includes.hpp"
+#include "inputbuffer.hpp"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+using std::string;
+using std::shared_ptr;
+
+namespace lc2kicad
+{
+  std::shared_ptr<InputFileBuffer> InputFileBuffer::mapFile(const string &path)
+  {
+    shared_ptr<InputFileBuffer> ret(new InputFileBuffer);
+    size_t fileSize = 0, pageSize = 0;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    assertThrow(file != INVALID_HANDLE_VALUE, "File \"" + path + "\" couldn't be opened. Parse of this file is aborted.");
+
+    LARGE_INTEGER largeSize;
+    SYSTEM_INFO sysInfo;
+    GetFileSizeEx(file, &largeSize);
+    GetSystemInfo(&sysInfo);
+    fileSize = static_cast<size_t>(largeSize.QuadPart);
+    pageSize = sysInfo.dwPageSize;
+
+    // Mapped views are zero filled up to the page boundary, which gives us the null terminator for free.
+    if(fileSize && fileSize % pageSize)
+    {
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+      if(mapping)
+      {
+        ret->buffer = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+        CloseHandle(mapping); // The view holds its own reference to the mapping object
+      }
+    }
+    CloseHandle(file);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    assertThrow(fd != -1, "File \"" + path + "\" couldn't be opened. Parse of this file is aborted.");
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) == 0)
+      fileSize = static_cast<size_t>(fileStat.st_size);
+    pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    // Private mapping: in-situ parsing writes into the pages, and those writes must never reach the file.
+    // The tail of the last page is zero filled, which gives us the null terminator for free.
+    if(fileSize && fileSize % pageSize)
+    {
+      void *mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      if(mapping != MAP_FAILED)
+      {
+        madvise(mapping, fileSize, MADV_SEQUENTIAL);
+        ret->buffer = static_cast<char*>(mapping);
+      }
+    }
+    close(fd);
+#endif
+
+    if(ret->buffer)
+    {
+      ret->length = fileSize;
+      ret->mapped = true;
+      return ret;
+    }
+
+    // Mapping is not possible, or there would be no room for the null terminator. Read the file instead.
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    assertThrow(!!file, "File \"" + path + "\" couldn't be opened. Parse of this file is aborted.");
+    return readStream(file);
+  }
+
+  std::shared_ptr<InputFileBuffer> InputFileBuffer::readStream(std::istream &stream)
+  {
+    shared_ptr<InputFileBuffer> ret(new InputFileBuffer);
+
+    ret->ownedStorage.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    ret->length = ret->ownedStorage.size();
+    ret->ownedStorage.push_back('\0');
+    ret->buffer = ret->ownedStorage.data();
+
+    return ret;
+  }
+
+  InputFileBuffer::~InputFileBuffer()
+  {
+    if(!mapped)
+      return;
+#ifdef _WIN32
+    UnmapViewOfFile(buffer);
+#else
+    munmap(buffer, length);
+#endif
+  }
+}
@@ -24,6 +24,7 @@
 #include <cmath>
 
 #include "includes.hpp"
+#include "outputbuffer.hpp"
 #include "internalsdeserializer.hpp"
 #include "edaclasses.hpp"
 
@@ -50,9 +51,13 @@ namespace lc2kicad
   
   KiCad_5_Deserializer::~KiCad_5_Deserializer() { };
 
-  string* KiCad_5_Deserializer::outputFileHeader()
+  /*
+   * Every output method writes its element into the output buffer, followed by a line break. Elements that
+   * can't be represented in KiCad write nothing at all.
+   */
+
+  void KiCad_5_Deserializer::outputFileHeader(OutputBuffer &out)
   {
-    RAIIC<string> ret;
     string timestamp = decToHex(time(nullptr));
     str_str_map &docInfo = workingDocument->docInfo;
     docInfo["timestamp"] = timestamp;
@@ -63,99 +68,121 @@ namespace lc2kicad
     switch(workingDocument->docType)
     {
       case documentTypes::schematic_lib:
-        *ret += "EESchema-LIBRARY Version 2.4\n"
-                "#encoding utf-8\n"
-                "#\n"
-                "# " + docInfo["documentname"] + "\n"
-                "#\n"
-                "DEF " + docInfo["documentname"] + " " + docInfo["prefix"] + " 0 40 Y Y 1 F N\n"
-                "F0 \"" + docInfo["prefix"] + "\" 0 50 50 H V C CNN\n"
-                "F1 \"" + docInfo["documentname"] + "\" 0 -50 50 H V C CNN\n"
-                "F2 \"\" 0 0 50 H I C CNN\n"
-                "F3 \"\" 0 0 50 H I C CNN\n"
-                "DRAW\n";
+        out << "EESchema-LIBRARY Version 2.4\n"
+               "#encoding utf-8\n"
+               "#\n"
+               "# " << docInfo["documentname"] << "\n"
+               "#\n"
+               "DEF " << docInfo["documentname"] << " " << docInfo["prefix"] << " 0 40 Y Y 1 F N\n"
+               "F0 \"" << docInfo["prefix"] << "\" 0 50 50 H V C CNN\n"
+               "F1 \"" << docInfo["documentname"] << "\" 0 -50 50 H V C CNN\n"
+               "F2 \"\" 0 0 50 H I C CNN\n"
+               "F3 \"\" 0 0 50 H I C CNN\n"
+               "DRAW\n";
         break;
       case documentTypes::pcb:
       {
-        *ret += "(kicad_pcb (version 20171130) (host pcbnew \"(5.1.4-0-10_14)\")\n";
-        *ret += static_cast<PCBDocument*>(workingDocument)->netManager.outputPCBNetInfo();
-
-        auto netclassStr = outputPCBNetclassRules(static_cast<PCBDocument*>(workingDocument)->netClasses);
-        *ret += *netclassStr;
-        delete netclassStr;
-
+        out << "(kicad_pcb (version 20171130) (host pcbnew \"(5.1.4-0-10_14)\")\n";
+        static_cast<PCBDocument*>(workingDocument)->netManager.outputPCBNetInfo(out);
+        outputPCBNetclassRules(static_cast<PCBDocument*>(workingDocument)->netClasses, out);
         break;
       }
       case documentTypes::pcb_lib:
-        *ret += "(module \"" + docInfo["documentname"] + "\" (tedit " + timestamp + ")\n"
-              + "  (fp_text reference REF*** (at 0 10) (layer F.SilkS)"
-                " (effects (font (size 1 1) (thickness 0.15))))\n"
-                "  (fp_text value \"" + docInfo["documentname"] + "\" (at 0 0) (layer F.Fab)"
-                " (effects (font (size 1 1) (thickness 0.15))))\n\n";
+        out << "(module \"" << docInfo["documentname"] << "\" (tedit " << timestamp << ")\n"
+               "  (fp_text reference REF*** (at 0 10) (layer F.SilkS)"
+               " (effects (font (size 1 1) (thickness 0.15))))\n"
+               "  (fp_text value \"" << docInfo["documentname"] << "\" (at 0 0) (layer F.Fab)"
+               " (effects (font (size 1 1) (thickness 0.15))))\n\n";
         indent += "";
         break;
       default:
         assertThrow(false, "Not implemented function: PCB deserializing not supported.");
     }
-    return !++ret;
+    out << '\n';
   }
 
-  string* KiCad_5_Deserializer::outputFileEnding()
+  void KiCad_5_Deserializer::outputFileEnding(OutputBuffer &out)
   {
-    RAIIC<string> ret;
     switch(workingDocument->docType)
     {
       case documentTypes::schematic_lib:
-        *ret += "ENDDRAW\n"
-                "ENDDEF\n"
-                "#\n"
-                "#End Library\n";
+        out << "ENDDRAW\n"
+               "ENDDEF\n"
+               "#\n"
+               "#End Library\n";
         break;
       case documentTypes::pcb:
       case documentTypes::pcb_lib:
-        *ret += ")";
+        out << ")";
         break;
       default:
         break;
     }
+    out << '\n';
     indent = "";
-    return !++ret;
   }
 
-  std::string *KiCad_5_Deserializer::outputPCBNetclassRules(const vector<PCBNetClass>& target)
+  void KiCad_5_Deserializer::outputPCBNetclassRules(const vector<PCBNetClass>& target, OutputBuffer &out)
   {
-    RAIIC<string> ret;
-
     for(auto &i : target)
     {
-      *ret += "(net_class \"" + i.name + "\" \"Default net class.\"\n";
+      out << "(net_class \"" << i.name << "\" \"Default net class.\"\n";
       for(auto &j : i.rules)
-        *ret += "  (" + j.first + " " + to_string(j.second) + ")\n";
+        out << "  (" << j.first << " " << j.second << ")\n";
 
       if(i.netClassMembers.size() > 0)
         for(auto &j : i.netClassMembers)
-          *ret += "  (add_net \"" + j + "\")\n";
+          out << "  (add_net \"" << j << "\")\n";
 
-      *ret += ")\n\n";
+      out << ")\n\n";
     }
+  }
 
-    return !++ret;
+  void KiCad_5_Deserializer::outputElement(const EDAElement &target, OutputBuffer &out)
+  {
+    switch(target.kind)
+    {
+      case PCBModule: outputPCBModule(static_cast<const PCB_Module&>(target), out); break;
+      case PCBPad: outputPCBPad(static_cast<const PCB_Pad&>(target), out); break;
+      case PCBGraphicalTrack: outputPCBGraphicalTrack(static_cast<const PCB_GraphicalTrack&>(target), out); break;
+      case PCBCopperTrack: outputPCBCopperTrack(static_cast<const PCB_CopperTrack&>(target), out); break;
+      case PCBHole: outputPCBHole(static_cast<const PCB_Hole&>(target), out); break;
+      case PCBVia: outputPCBVia(static_cast<const PCB_Via&>(target), out); break;
+      case PCBSolidRegion: outputPCBGraphicalSolidRegion(static_cast<const PCB_GraphicalSolidRegion&>(target), out); break;
+      case PCBCopperSolidRegion: outputPCBCopperSolidRegion(static_cast<const PCB_CopperSolidRegion&>(target), out); break;
+      case PCBFloodFill: outputPCBFloodFill(static_cast<const PCB_FloodFill&>(target), out); break;
+      case PCBKeepoutRegion: outputPCBKeepoutRegion(static_cast<const PCB_KeepoutRegion&>(target), out); break;
+      case PCBGraphicalCircle: outputPCBGraphicalCircle(static_cast<const PCB_GraphicalCircle&>(target), out); break;
+      case PCBCopperCircle: outputPCBCopperCircle(static_cast<const PCB_CopperCircle&>(target), out); break;
+      case PCBRect: outputPCBRect(static_cast<const PCB_Rect&>(target), out); break;
+      case PCBGraphicalArc: outputPCBGraphicalArc(static_cast<const PCB_GraphicalArc&>(target), out); break;
+      case PCBCopperArc: outputPCBCopperArc(static_cast<const PCB_CopperArc&>(target), out); break;
+      case PCBText: outputPCBText(static_cast<const PCB_Text&>(target), out); break;
+
+      case SchModule: outputSchModule(static_cast<const Schematic_Module&>(target), out); break;
+      case SchPin: outputSchPin(static_cast<const Schematic_Pin&>(target), out); break;
+      case SchPolyline: outputSchPolyline(static_cast<const Schematic_Polyline&>(target), out); break;
+      case SchText: outputSchText(static_cast<const Schematic_Text&>(target), out); break;
+      case SchRect: outputSchRect(static_cast<const Schematic_Rect&>(target), out); break;
+      case SchPolygon: outputSchPolygon(static_cast<const Schematic_Polygon&>(target), out); break;
+      case SchArc: outputSchArc(static_cast<const Schematic_Arc&>(target), out); break;
+
+      default:
+        assertThrow(false, target.id + ": Element of unknown type " + std::to_string(target.kind) + " can't be written.");
+    }
   }
 
-  string* KiCad_5_Deserializer::outputPCBModule(const PCB_Module& target)
+  void KiCad_5_Deserializer::outputPCBModule(const PCB_Module& target, OutputBuffer &out)
   {
-    RAIIC<string> ret;
-    string* elementOutput;
-    
     if(!workingDocument->module) // Do not output when dealing with PCB module file, but do it for PCB nested modules
     {
       indent = "  ";
-      *ret += "(module \"LC2KICAD:" + target.name + "\" (layer " + KiCadLayerName[target.layer] + ") (at "
-           + to_string(target.moduleCoords.X) + ' ' + to_string(target.moduleCoords.Y) /*+ ' ' + to_string(target.orientation)*/ + ")\n"
-           + indent + "  (fp_text reference REF*** (at 0 10) (layer F.SilkS)"
-           "  (effects (font (size 1 1) (thickness 0.15))))\n"
-           "   (fp_text value \"" + target.name + "\" (at 0 0) (layer F.Fab)"
-           "  (effects (font (size 1 1) (thickness 0.15))))\n\n";
+      out << "(module \"LC2KICAD:" << target.name << "\" (layer " << KiCadLayerName[target.layer] << ") (at "
+          << target.moduleCoords.X << ' ' << target.moduleCoords.Y /*<< ' ' << target.orientation*/ << ")\n"
+          << indent << "  (fp_text reference REF*** (at 0 10) (layer F.SilkS)"
+             "  (effects (font (size 1 1) (thickness 0.15))))\n"
+             "   (fp_text value \"" << target.name << "\" (at 0 0) (layer F.Fab)"
+             "  (effects (font (size 1 1) (thickness 0.15))))\n\n";
     }
 
     processingModule = true;
@@ -163,342 +190,310 @@ namespace lc2kicad
     for(auto &i : target.containedElements)
     {
       if(!i) continue;
-      elementOutput = i->deserializeSelf(*this);
-      if(elementOutput)
-      {
-        *ret += *elementOutput + "\n";
-        delete elementOutput;
-      }
+      outputElement(*i, out);
     }
     processingModule = false; // TODO: RAII
 
     if(!workingDocument->module)
-      *ret += ")\n";
+      out << ")\n";
 
     indent = "";
     
-    return !++ret;
+    out << '\n';
   }
 
-  string* KiCad_5_Deserializer::outputPCBPad(const PCB_Pad& target) const
+  void KiCad_5_Deserializer::outputPCBPad(const PCB_Pad& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    *ret += indent;
-    *ret += "(pad \"" + target.pinNumber + "\" " + padTypeKiCad[static_cast<int>(target.padType)] + ' '
-          + padShapeKiCad[static_cast<int>(target.padShape)] + " (at " + to_string(target.padCoordinates.X)
-          + ' ' + to_string(target.padCoordinates.Y) + (target.orientation ? " " + to_string(target.orientation) : "")
-          + ") (size " + to_string(target.padSize.X) + ' '+ to_string(target.padSize.Y);
+    out << indent;
+    out << "(pad \"" << target.pinNumber << "\" " << padTypeKiCad[static_cast<int>(target.padType)] << ' '
+        << padShapeKiCad[static_cast<int>(target.padShape)] << " (at " << target.padCoordinates.X
+        << ' ' << target.padCoordinates.Y;
+    if(target.orientation)
+      out << ' ' << target.orientation;
+    out << ") (size " << target.padSize.X << ' ' << target.padSize.Y;
     if(target.padType == PCBPadType::through || target.padType == PCBPadType::noplating)
     {
-      *ret += ") (drill";
+      out << ") (drill";
       if(target.holeShape == PCBHoleShape::slot)
       {
-        *ret += " oval " + to_string(target.holeSize.X) + ' ' + to_string(target.holeSize.Y);
+        out << " oval " << target.holeSize.X << ' ' << target.holeSize.Y;
       }
       else
       {
-        *ret += ' ' + to_string(target.holeSize.X);
+        out << ' ' << target.holeSize.X;
       }
     }
-    *ret += ") (layers ";
+    out << ") (layers ";
 
     switch(target.padType)
     {
       case PCBPadType::top:
-        *ret += "F.Cu F.Paste F.Mask)";
+        out << "F.Cu F.Paste F.Mask)";
         break;
       case PCBPadType::bottom:
-        *ret += "B.Cu B.Paste B.Mask)";
+        out << "B.Cu B.Paste B.Mask)";
         break;
       default:
-        *ret += "*.Cu *.Mask)";
+        out << "*.Cu *.Mask)";
     }
 
     if(isProcessingModules())
     {
-      if(target.net.second != "")
-        *ret += " (net " + to_string(target.net.first) + " \"" + target.net.second + "\")";
+      if(target.net != 0)
+        out << " (net " << target.net << " \"" << netName(target.net) << "\")";
     }
 
     if(target.padShape != PCBPadShape::polygon)
-      *ret += ')';
+      out << ')';
 
     else
     {
-      *ret += string("\n") + indent + string("  (zone_connect 2)") + '\n' + indent +
-              "  (options (clearance outline) (anchor circle))\n"
-            + indent + "  (primitives\n" + indent + "    (gr_poly (pts\n      " + indent;
+      out << '\n' << indent << "  (zone_connect 2)" << '\n' << indent
+          << "  (options (clearance outline) (anchor circle))\n"
+          << indent << "  (primitives\n" << indent << "    (gr_poly (pts\n      " << indent;
       for(coordinates i : target.shapePolygonPoints)
-        *ret += " (xy " + to_string(i.X) + ' ' + to_string(i.Y) + ')';
-      *ret += string(") (width 0))\n") + indent + "  ))";
+        out << " (xy " << i.X << ' ' << i.Y << ')';
+      out << ") (width 0))\n" << indent << "  ))";
     }
-    return !++ret;
+    out << '\n';
   }
 
-  string* KiCad_5_Deserializer::outputPCBVia(const PCB_Via& target) const
+  void KiCad_5_Deserializer::outputPCBVia(const PCB_Via& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-
     if(!isProcessingModules())
     { // Ordinary Vias on PCBs
-      *ret += indent;
-      *ret += "(via (at " + to_string(target.holeCoordinates.X) + ' ' + to_string(target.holeCoordinates.Y) + ") (size "
-              + to_string(target.viaDiameter)
-              + ") (drill " + to_string(target.holeDiameter) + ") (layers ";
+      out << indent;
+      out << "(via (at " << target.holeCoordinates.X << ' ' << target.holeCoordinates.Y << ") (size "
+          << target.viaDiameter
+          << ") (drill " << target.holeDiameter << ") (layers ";
 
       // LCEDA currently doesn't support buried or blind vias. If this function is implemented later, we'll have to update
       // the layer section.
-      *ret += "F.Cu B.Cu";
+      out << "F.Cu B.Cu";
 
-      *ret += ") (net " + to_string(target.net.first) + "))";
+      out << ") (net " << target.net << "))";
     }
     else
     { // Vias got converted to pads inside footprints
       VERBOSE_INFO(target.id + ": this via is in a footprint and is output as a pad.");
-      *ret += indent
-            + "(pad 0 thru_hole circle (at " + to_string(target.holeCoordinates.X)
-            + ' ' + to_string(target.holeCoordinates.Y) + ") (size " + to_string(target.viaDiameter)
-            + ' '+ to_string(target.viaDiameter) + ") (drill " + to_string(target.holeDiameter) + ") (layers *.Cu)"
-            + (workingDocument->module ? ")" : " (net " + to_string(target.net.first) + " \"" + target.net.second + "\"))");
+      out << indent
+          << "(pad 0 thru_hole circle (at " << target.holeCoordinates.X
+          << ' ' << target.holeCoordinates.Y << ") (size " << target.viaDiameter
+          << ' ' << target.viaDiameter << ") (drill " << target.holeDiameter << ") (layers *.Cu)";
+      if(workingDocument->module)
+        out << ")";
+      else
+        out << " (net " << target.net << " \"" << netName(target.net) << "\"))";
     }
-    return !++ret;
+    out << '\n';
   }
 
-  string* KiCad_5_Deserializer::outputPCBCopperTrack(const PCB_CopperTrack& target) const
+  void KiCad_5_Deserializer::outputPCBCopperTrack(const PCB_CopperTrack& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
     bool isInFootprint = isProcessingModules(); // If not in a footprint, use gr_line. Else, use fp_line
 
     if(isInFootprint)
       Warn(target.id + ": Copper track on footprint. This can cause DRC violations.");
 
-    for(unsigned int i = 0; i < target.trackPoints.size() - 1; i++)
+    for(unsigned int i = 0; i + 1 < target.trackPoints.size(); i++)
     {
-      *ret += indent + string(isInFootprint ? "(fp_line (start " : "(segment (start ") + to_string(target.trackPoints[i].X) + ' '
-           + to_string(target.trackPoints[i].Y) + ") (end " + to_string(target.trackPoints[i + 1].X) + ' '
-           + to_string(target.trackPoints[i + 1].Y) + ") (width " + to_string(target.width) + ") (layer "
-           + KiCadLayerName[target.layerKiCad] + ")";
+      out << indent << (isInFootprint ? "(fp_line (start " : "(segment (start ") << target.trackPoints[i].X << ' '
+          << target.trackPoints[i].Y << ") (end " << target.trackPoints[i + 1].X << ' '
+          << target.trackPoints[i + 1].Y << ") (width " << target.width << ") (layer "
+          << KiCadLayerName[target.layerKiCad] << ")";
       if(!isInFootprint)
-        *ret += "(net " + to_string(target.net.first) + ")";
-      *ret += ")\n";
+        out << "(net " << target.net << ")";
+      out << ")\n";
     }
-
-    ret->pop_back(); // Remove the last '\n' because no end-of-line is needed at the end right there
-    
-    return !++ret;
   }
 
-  string* KiCad_5_Deserializer::outputPCBGraphicalTrack(const PCB_GraphicalTrack& target) const
+  void KiCad_5_Deserializer::outputPCBGraphicalTrack(const PCB_GraphicalTrack& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
     bool isInFootprint = isProcessingModules(); // If not in a footprint, use gr_line. Else, use fp_line
 
-    for(unsigned int i = 0; i < target.trackPoints.size() - 1; i++)
-      *ret += indent + string(isInFootprint ? "(fp_line (start " : "(gr_line (start ") + to_string(target.trackPoints[i].X)
-           + ' ' + to_string(target.trackPoints[i].Y) + ") (end " + to_string(target.trackPoints[i + 1].X) + ' '
-           + to_string(target.trackPoints[i + 1].Y) + ") (layer " + KiCadLayerName[target.layerKiCad] + ") (width "
-           + to_string(target.width) + "))\n";
-
-    ret->pop_back(); // Remove the last '\n' because no end-of-line is needed at the end right there
-    
-    return !++ret;
+    for(unsigned int i = 0; i + 1 < target.trackPoints.size(); i++)
+      out << indent << (isInFootprint ? "(fp_line (start " : "(gr_line (start ") << target.trackPoints[i].X
+          << ' ' << target.trackPoints[i].Y << ") (end " << target.trackPoints[i + 1].X << ' '
+          << target.trackPoints[i + 1].Y << ") (layer " << KiCadLayerName[target.layerKiCad] << ") (width "
+          << target.width << "))\n";
   }
 
-  string* KiCad_5_Deserializer::outputPCBFloodFill(const PCB_FloodFill& target) const
+  void KiCad_5_Deserializer::outputPCBFloodFill(const PCB_FloodFill& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-
     if(isProcessingModules())
     {
       Warn(target.id + ": Fill areas are not allowed within footprint. This area was discarded.");
-      return nullptr;
+      return;
     }
 
-    *ret += indent + string("(zone (net ") + to_string(target.net.first) + ") (net_name \"" + target.net.second
-        + "\") (layer " + KiCadLayerName[target.layerKiCad] + ") (tstamp 0) (hatch edge 0.508)\n"
+    out << indent << "(zone (net " << target.net << ") (net_name \"" << netName(target.net)
+        << "\") (layer " << KiCadLayerName[target.layerKiCad] << ") (tstamp 0) (hatch edge 0.508)\n"
 
-        + indent + "  (priority " + to_string(static_cast<PCBDocument*>(workingDocument)->fillPriorityManager
-                                              .getKiCadPriority(target.EasyEDAPriority)) + ")"
+        << indent << "  (priority " << static_cast<PCBDocument*>(workingDocument)->fillPriorityManager
+                                         .getKiCadPriority(target.EasyEDAPriority) << ")"
 
-        + indent + "  (connect_pads " + (target.isSpokeConnection ? "" : "yes") + " (clearance "
-        + to_string(target.clearanceWidth) + "))\n"
+        << indent << "  (connect_pads " << (target.isSpokeConnection ? "" : "yes") << " (clearance "
+        << target.clearanceWidth << "))\n"
 
-        + indent + "  (min_thickness " + to_string(target.minimumWidth) + ")\n"
+        << indent << "  (min_thickness " << target.minimumWidth << ")\n"
 
-        + indent + "  (fill " + (target.fillStyle == floodFillStyle::noFill ? "no" : "yes")
-        + " (arc_segments 32) (thermal_gap " + to_string(target.clearanceWidth) + ") (thermal_bridge_width "
-        + to_string(target.spokeWidth) + "))\n"
+        << indent << "  (fill " << (target.fillStyle == floodFillStyle::noFill ? "no" : "yes")
+        << " (arc_segments 32) (thermal_gap " << target.clearanceWidth << ") (thermal_bridge_width "
+        << target.spokeWidth << "))\n"
 
-        + indent + "  (polygon\n"
-        + indent + "    (pts\n"
-        + indent + "      ";
+        << indent << "  (polygon\n"
+        << indent << "    (pts\n"
+        << indent << "      ";
     
     for(coordinates i : target.fillAreaPolygonPoints)
-      *ret += "(xy " + to_string(i.X) + ' ' + to_string(i.Y) + ") ";
+      out << "(xy " << i.X << ' ' << i.Y << ") ";
 
-    *ret += indent + string("    )\n") + indent + "  )\n" + indent + ")";
-
-    return !++ret;
+    out << indent << "    )\n" << indent << "  )\n" << indent << ")\n";
   }
 
-  string* KiCad_5_Deserializer::outputPCBKeepoutRegion(const PCB_KeepoutRegion& target) const
+  void KiCad_5_Deserializer::outputPCBKeepoutRegion(const PCB_KeepoutRegion& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-
     // TODO: disallow only if you specify KiCad 5
     if(isProcessingModules())
     {
       Warn(target.id + ": Keepout areas are not allowed within footprint in KiCad 5. This area was discarded.");
-      return nullptr;
+      return;
     }
 
-    *ret += indent + "(zone (net 0) (net_name \"\") (layer " + KiCadLayerName[target.layerKiCad] + ") (tstamp 0) (hatch edge 0.508)\n"
-          + indent + "  (connect_pads (clearance 0.508))\n"
-          + indent + "  (min_thickness 0.254)\n"
-          + indent + "  (keepout (tracks " + (target.allowRouting ? "allowed" : "not_allowed")
-                   + ") (vias " + (target.allowVias ? "allowed" : "not_allowed")
-                   + ") (copperpour " + (target.allowFloodFill ? "allowed" : "not_allowed") + "))\n"
-          + indent + "  (fill (arc_segments 32) (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
-          + indent + "  (polygon\n"
-          + indent + "    (pts\n"
-          + indent + "      ";
+    out << indent << "(zone (net 0) (net_name \"\") (layer " << KiCadLayerName[target.layerKiCad] << ") (tstamp 0) (hatch edge 0.508)\n"
+        << indent << "  (connect_pads (clearance 0.508))\n"
+        << indent << "  (min_thickness 0.254)\n"
+        << indent << "  (keepout (tracks " << (target.allowRouting ? "allowed" : "not_allowed")
+                  << ") (vias " << (target.allowVias ? "allowed" : "not_allowed")
+                  << ") (copperpour " << (target.allowFloodFill ? "allowed" : "not_allowed") << "))\n"
+        << indent << "  (fill (arc_segments 32) (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
+        << indent << "  (polygon\n"
+        << indent << "    (pts\n"
+        << indent << "      ";
     for(coordinates i : target.fillAreaPolygonPoints)
-      *ret += "(xy " + to_string(i.X) + ' ' + to_string(i.Y) + ") ";
-    *ret += indent + "    )\n"
-          + indent + "  )\n"
-          + indent + ")";
-
-    return !++ret;
+      out << "(xy " << i.X << ' ' << i.Y << ") ";
+    out << indent << "    )\n"
+        << indent << "  )\n"
+        << indent << ")\n";
   }
   
-  string* KiCad_5_Deserializer::outputPCBCopperCircle(const PCB_CopperCircle& target) const
+  void KiCad_5_Deserializer::outputPCBCopperCircle(const PCB_CopperCircle& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-
     // Warn the user about this
     if(isProcessingModules())
       Warn(target.id + ": Copper track on footprint. This can cause DRC violations.");
 
-    *ret += indent + string(isProcessingModules() ? "(fp_circle " : "(gr_circle ")
-          + "(center " + to_string(target.center.X) + ' ' + to_string(target.center.Y) + ") "
-            "(end " + to_string(target.center.X) + ' ' + to_string(target.center.Y + target.radius) + ") "
-            "(layer " + KiCadLayerName[target.layerKiCad]
-          + ") (width " + to_string(target.width) + "))\n";
-    
-    return !++ret;
+    out << indent << (isProcessingModules() ? "(fp_circle " : "(gr_circle ")
+        << "(center " << target.center.X << ' ' << target.center.Y << ") "
+           "(end " << target.center.X << ' ' << target.center.Y + target.radius << ") "
+           "(layer " << KiCadLayerName[target.layerKiCad]
+        << ") (width " << target.width << "))\n\n";
   }
   
-  string* KiCad_5_Deserializer::outputPCBGraphicalCircle(const PCB_GraphicalCircle& target) const
+  void KiCad_5_Deserializer::outputPCBGraphicalCircle(const PCB_GraphicalCircle& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-
-    *ret += indent + string(isProcessingModules() ? "(fp_circle (center " : "(gr_circle (center ") + to_string(target.center.X)
-          + ' ' + to_string(target.center.Y) + ") (end " + to_string(target.center.X) + ' ' + to_string(target.center.Y + target.radius)
-          + ") (layer " + KiCadLayerName[target.layerKiCad] + ") (width " + to_string(target.width) + "))";
-    
-    return !++ret;
+    out << indent << (isProcessingModules() ? "(fp_circle (center " : "(gr_circle (center ") << target.center.X
+        << ' ' << target.center.Y << ") (end " << target.center.X << ' ' << target.center.Y + target.radius
+        << ") (layer " << KiCadLayerName[target.layerKiCad] << ") (width " << target.width << "))\n";
   }
 
-  string* KiCad_5_Deserializer::outputPCBHole(const PCB_Hole& target) const
+  void KiCad_5_Deserializer::outputPCBHole(const PCB_Hole& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-
     if(isProcessingModules())
-      *ret += indent + 
-              "(pad \"\" np_thru_hole circle (at " + to_string(target.holeCoordinates.X) + " " + to_string(target.holeCoordinates.Y) + ") "
-              "(size " + to_string(target.holeDiameter) + " " + to_string(target.holeDiameter) + ")"
-              "(drill " + to_string(target.holeDiameter) + ") (layers *.Cu *.Mask))";
+      out << indent << 
+             "(pad \"\" np_thru_hole circle (at " << target.holeCoordinates.X << " " << target.holeCoordinates.Y << ") "
+             "(size " << target.holeDiameter << " " << target.holeDiameter << ")"
+             "(drill " << target.holeDiameter << ") (layers *.Cu *.Mask))\n";
     else
-      *ret += "  (module MountingHole_NonPlated_Converted (layer F.Cu)\n"
-              "    (at " + to_string(target.holeCoordinates.X) + " " + to_string(target.holeCoordinates.Y) + ")\n"
-              "    (descr MountingHold_NonPlated_Converted)\n"
-              "    (pad \"\" np_thru_hole circle (at 0 0) (size " + to_string(target.holeDiameter) + " " + to_string(target.holeDiameter) + ")"
-              "   (drill " + to_string(target.holeDiameter) + ") (layers *.Cu *.Mask))\n"
-              "  )";
-    return !++ret;
+      out << "  (module MountingHole_NonPlated_Converted (layer F.Cu)\n"
+             "    (at " << target.holeCoordinates.X << " " << target.holeCoordinates.Y << ")\n"
+             "    (descr MountingHold_NonPlated_Converted)\n"
+             "    (pad \"\" np_thru_hole circle (at 0 0) (size " << target.holeDiameter << " " << target.holeDiameter << ")"
+             "   (drill " << target.holeDiameter << ") (layers *.Cu *.Mask))\n"
+             "  )\n";
   }
 
-  string* KiCad_5_Deserializer::outputPCBRect(const PCB_Rect& target) const
+  void KiCad_5_Deserializer::outputPCBRect(const PCB_Rect& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    string x1 = to_string(target.topLeftPos.X),
-           y1 = to_string(target.topLeftPos.Y),
-           x2 = to_string(target.topLeftPos.X + target.size.X),
-           y2 = to_string(target.topLeftPos.Y + target.size.Y),
-           w = to_string(target.strokeWidth);
+    double x1 = target.topLeftPos.X,
+           y1 = target.topLeftPos.Y,
+           x2 = target.topLeftPos.X + target.size.X,
+           y2 = target.topLeftPos.Y + target.size.Y,
+           w = target.strokeWidth;
+    const char *layer = KiCadLayerName[target.layerKiCad];
 
     if(isProcessingModules())
     {
       
-      *ret += indent + "(fp_line (start " + x1 + " " + y1 + ") (end " + x2 + " " + y1 + ") (layer " + KiCadLayerName[target.layerKiCad]
-                     + ") (width " + w + "))\n";
-      *ret += indent + "(fp_line (start " + x2 + " " + y1 + ") (end " + x2 + " " + y2 + ") (layer " + KiCadLayerName[target.layerKiCad]
-                     + ") (width " + w + "))\n";
-      *ret += indent + "(fp_line (start " + x2 + " " + y2 + ") (end " + x1 + " " + y2 + ") (layer " + KiCadLayerName[target.layerKiCad]
-                     + ") (width " + w + "))\n";
-      *ret += indent + "(fp_line (start " + x1 + " " + y2 + ") (end " + x1 + " " + y1 + ") (layer " + KiCadLayerName[target.layerKiCad]
-                     + ") (width " + w + "))\n";
+      out << indent << "(fp_line (start " << x1 << " " << y1 << ") (end " << x2 << " " << y1 << ") (layer " << layer
+                    << ") (width " << w << "))\n";
+      out << indent << "(fp_line (start " << x2 << " " << y1 << ") (end " << x2 << " " << y2 << ") (layer " << layer
+                    << ") (width " << w << "))\n";
+      out << indent << "(fp_line (start " << x2 << " " << y2 << ") (end " << x1 << " " << y2 << ") (layer " << layer
+                    << ") (width " << w << "))\n";
+      out << indent << "(fp_line (start " << x1 << " " << y2 << ") (end " << x1 << " " << y1 << ") (layer " << layer
+                    << ") (width " << w << "))\n";
     }
     else
     {
-      *ret += "  (gr_poly (pts (xy " + x1 + " " + y1 + ") (xy " + x1 + " " + y2 + ") (xy " + x2 + ' ' + y2 + ") (xy " + x1 + ' ' + y2 + ")) "
-              "(layer " + KiCadLayerName[target.layerKiCad] + ") (width " + w + "))";
+      out << "  (gr_poly (pts (xy " << x1 << " " << y1 << ") (xy " << x1 << " " << y2 << ") (xy " << x2 << ' ' << y2 << ") (xy " << x1 << ' ' << y2 << ")) "
+             "(layer " << layer << ") (width " << w << "))";
     }
-
-    return !++ret;
+    out << '\n';
   }
 
-  string *KiCad_5_Deserializer::outputPCBText(const PCB_Text& target) const
+  void KiCad_5_Deserializer::outputPCBText(const PCB_Text& target, OutputBuffer &out) const
   {
     //if(target.type == PCBTextTypes::StandardText && (processingModule | isProcessingModules()))
-    //  return nullptr;
+    //  return;
+
+    if(target.type == PCBTextTypes::PackageName)
+      return;
 
-    RAIIC<string> ret;
-    *ret += indent + ((isProcessingModules()) ? "(fp_text " : "(gr_text ");
+    out << indent << ((isProcessingModules()) ? "(fp_text " : "(gr_text ");
     switch(target.type)
     {
-      case PCBTextTypes::StandardText: if(isProcessingModules()) *ret += "user"; break;
-      case PCBTextTypes::PackageReference: *ret += "reference"; break;
-      case PCBTextTypes::PackageValue: *ret += "value"; break;
-      case PCBTextTypes::PackageName: return nullptr; break;
+      case PCBTextTypes::StandardText: if(isProcessingModules()) out << "user"; break;
+      case PCBTextTypes::PackageReference: out << "reference"; break;
+      case PCBTextTypes::PackageValue: out << "value"; break;
       default:
         break;
     }
-    *ret += indent
-          + " \"" + target.text + "\" (at " + to_string(target.midLeftPos.X) + ' ' + to_string(target.midLeftPos.Y)
-          + (target.orientation ? " " + to_string(target.orientation) + ") " : ") ") + "(layer "
-          + (target.type == PCBTextTypes::PackageValue ?
-               target.layerKiCad == F_SilkS ? KiCadLayerName[F_Fab] : KiCadLayerName[B_Fab]
-                                              : KiCadLayerName[target.layerKiCad]);
+    out << indent
+        << " \"" << target.text << "\" (at " << target.midLeftPos.X << ' ' << target.midLeftPos.Y;
+    if(target.orientation)
+      out << ' ' << target.orientation << ") ";
+    else
+      out << ") ";
+    out << "(layer "
+        << (target.type == PCBTextTypes::PackageValue ?
+              target.layerKiCad == F_SilkS ? KiCadLayerName[F_Fab] : KiCadLayerName[B_Fab]
+                                             : KiCadLayerName[target.layerKiCad]);
     if((workingDocument->module | processingModule))
       if(!target.visibility)
-        *ret += ") hide\n";
+        out << ") hide\n";
       else
-        *ret += ")\n";
+        out << ")\n";
     else
-      *ret += ")\n";
+      out << ")\n";
 
-    *ret += indent + "  (effects (font (size " + to_string(target.height) + ' ' + to_string(target.height) + ") (thickness "
-          + to_string(target.width) + ")) (justify left";
+    out << indent << "  (effects (font (size " << target.height << ' ' << target.height << ") (thickness "
+        << target.width << ")) (justify left";
     if(target.mirrored)
-      *ret += " mirror";
-    *ret += "))\n"
-
-          + indent + ")\n";
+      out << " mirror";
+    out << "))\n"
 
-    return !++ret;
+        << indent << ")\n\n";
   }
 
-  string* KiCad_5_Deserializer::outputPCBCopperSolidRegion(const PCB_CopperSolidRegion& target) const
+  void KiCad_5_Deserializer::outputPCBCopperSolidRegion(const PCB_CopperSolidRegion& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
     Warn("KiCad_5_Deserializer::outputPCBSolidRegion stub. " + target.id + "is ignored.");
-    return !++ret;
+    out << '\n';
   }
 
-  string *KiCad_5_Deserializer::outputPCBGraphicalSolidRegion(const PCB_GraphicalSolidRegion& target) const
+  void KiCad_5_Deserializer::outputPCBGraphicalSolidRegion(const PCB_GraphicalSolidRegion& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
     KiCadLayerIndex realLayer;
     // NOTE: Although the hacks of courtyard doesn't cover all cases, but till now, all instances of
     //       EasyEDA courtyards are solid fills. so this should work
@@ -506,149 +501,123 @@ namespace lc2kicad
       realLayer = B_CrtYd;
     else
       realLayer = target.layerKiCad;
-    *ret += (isProcessingModules() ? "(fp_poly (pts " : "(gr_poly (pts ");
-    for(auto &i : target.fillAreaPolygonPoints)
-      *ret += "(xy " + to_string(i.X) + ' ' + to_string(i.Y) + ") ";
-    *ret += ") (layer " + KiCadLayerName[realLayer] + ") (fill ";
+    out << (isProcessingModules() ? "(fp_poly (pts " : "(gr_poly (pts ");
+    for(coordinates i : target.fillAreaPolygonPoints)
+      out << "(xy " << i.X << ' ' << i.Y << ") ";
+    out << ") (layer " << KiCadLayerName[realLayer] << ") (fill ";
 
     if(realLayer == F_CrtYd || realLayer == B_CrtYd)
-      *ret += "none) (width 0.508))";
+      out << "none) (width 0.508))\n";
     else
-      *ret += "solid) (width 0))";
-
-    return !++ret;
+      out << "solid) (width 0))\n";
   }
 
-  string* KiCad_5_Deserializer::outputPCBGraphicalArc(const PCB_GraphicalArc& target) const
+  void KiCad_5_Deserializer::outputPCBGraphicalArc(const PCB_GraphicalArc& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    *ret += ((isProcessingModules()) ? "(fp_arc (start " : "(gr_arc (start ") + to_string(target.center.X)
-          + ' ' + to_string(target.center.Y) + ") (end " + to_string(target.endPoint.X) + ' ' + to_string(target.endPoint.Y)
-          + ") (angle " + to_string(target.angle) + ") (layer " + KiCadLayerName[target.layerKiCad]
-          + ") (width " + to_string(target.width) + "))";
-    return !++ret;
+    out << ((isProcessingModules()) ? "(fp_arc (start " : "(gr_arc (start ") << target.center.X
+        << ' ' << target.center.Y << ") (end " << target.endPoint.X << ' ' << target.endPoint.Y
+        << ") (angle " << target.angle << ") (layer " << KiCadLayerName[target.layerKiCad]
+        << ") (width " << target.width << "))\n";
   }
 
-  string* KiCad_5_Deserializer::outputPCBCopperArc(const PCB_CopperArc& target) const
+  void KiCad_5_Deserializer::outputPCBCopperArc(const PCB_CopperArc& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    *ret += ((isProcessingModules()) ? "(fp_arc (start " : "(gr_arc (start ") + to_string(target.center.X)
-          + ' ' + to_string(target.center.Y) + ") (end " + to_string(target.endPoint.X) + ' ' + to_string(target.endPoint.Y)
-          + ") (angle " + to_string(target.angle) + ") (layer " + KiCadLayerName[target.layerKiCad]
-          + ") (width " + to_string(target.width) + "))";
+    out << ((isProcessingModules()) ? "(fp_arc (start " : "(gr_arc (start ") << target.center.X
+        << ' ' << target.center.Y << ") (end " << target.endPoint.X << ' ' << target.endPoint.Y
+        << ") (angle " << target.angle << ") (layer " << KiCadLayerName[target.layerKiCad]
+        << ") (width " << target.width << "))\n";
     Warn(target.id + ": KiCad 5 doesn't support copper layer arc with nets. Net info of this copper arc is discarded.");
-    return !++ret;
   }
 
-  string* KiCad_5_Deserializer::outputSchModule(const Schematic_Module& target)
+  void KiCad_5_Deserializer::outputSchModule(const Schematic_Module& target, OutputBuffer &out)
   {
-    RAIIC<string> ret;
     if(isProcessingModules())
-    {
-      string* elementOutput;
-
       for(auto &i : target.containedElements)
-      {
-        elementOutput = i->deserializeSelf(*this);
-        *ret += *elementOutput + "\n";
-        delete elementOutput;
-      }
-    }
-    return !++ret;
+        outputElement(*i, out);
+    out << '\n';
   }
   
   // KiCad schematic pin output, legacy format.
-  string* KiCad_5_Deserializer::outputSchPin(const Schematic_Pin& target) const
+  void KiCad_5_Deserializer::outputSchPin(const Schematic_Pin& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    *ret += "X " + target.pinName + " " + target.pinNumber + " " + to_string(static_cast<int>(target.pinCoord.X)) + " "
-          + to_string(static_cast<int>(target.pinCoord.Y)) + " " + to_string(static_cast<int>(target.pinLength)) + " ";
+    out << "X " << target.pinName << " " << target.pinNumber << " " << static_cast<int>(target.pinCoord.X) << " "
+        << static_cast<int>(target.pinCoord.Y) << " " << static_cast<int>(target.pinLength) << " ";
     switch(target.pinRotation)
     {
       default:
       case SchematicRotations::Deg0:
-        *ret += "L "; break;
+        out << "L "; break;
       case SchematicRotations::Deg90:
-        *ret += "D "; break;
+        out << "D "; break;
       case SchematicRotations::Deg180:
-        *ret += "R "; break;
+        out << "R "; break;
       case SchematicRotations::Deg270:
-        *ret += "U "; break;
+        out << "U "; break;
     }
 
-    *ret += to_string(target.fontSize) + " " + to_string(target.fontSize) + " ";
-    *ret += "1 0 ";
+    out << target.fontSize << " " << target.fontSize << " ";
+    out << "1 0 ";
 
     //Electrical property. EasyEDA didn't split power in and power out, so power would become passive to avoid ERC violations.
     switch (target.electricProperty)
     {
       case SchPinElectricProperty::Unspecified:
-        *ret += "U "; break;
+        out << "U "; break;
       case SchPinElectricProperty::Input:
-        *ret += "I "; break;
+        out << "I "; break;
       case SchPinElectricProperty::Output:
-        *ret += "O "; break;
+        out << "O "; break;
       case SchPinElectricProperty::Bidirectional:
-        *ret += "B "; break;
+        out << "B "; break;
       case SchPinElectricProperty::Power:
       default:
-        *ret += "P "; break;
+        out << "P "; break;
     }
-    *ret += target.clock ? target.inverted ? "IC" : "C" : target.inverted ? "I" : ""; //Either clock, or target. Or both, or none.
-    
-    return !++ret;
+    out << (target.clock ? target.inverted ? "IC" : "C" : target.inverted ? "I" : ""); //Either clock, or target. Or both, or none.
+    out << '\n';
   }
   
-  string* KiCad_5_Deserializer::outputSchPolyline(const Schematic_Polyline& target) const
+  void KiCad_5_Deserializer::outputSchPolyline(const Schematic_Polyline& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    *ret += "P " + to_string(target.polylinePoints.size()) + " 0 0 " + to_string(target.lineWidth) + " ";
+    out << "P " << target.polylinePoints.size() << " 0 0 " << target.lineWidth << " ";
     for(auto &i : target.polylinePoints)
-      *ret += to_string(static_cast<int>(i.X)) + " " + to_string(static_cast<int>(i.Y)) + " ";
-    *ret += (target.isFilled ? "f" : "N");
-    return !++ret;
+      out << static_cast<int>(i.X) << " " << static_cast<int>(i.Y) << " ";
+    out << (target.isFilled ? "f" : "N") << '\n';
   }
   
-  string* KiCad_5_Deserializer::outputSchRect(const Schematic_Rect& target) const
+  void KiCad_5_Deserializer::outputSchRect(const Schematic_Rect& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    *ret += "S " + to_string(static_cast<int>(target.position.X)) + " " + to_string(static_cast<int>(target.position.Y)) + " "
-         + to_string(static_cast<int>(target.size.X + target.position.X)) + " "          // KiCad uses the top-left and bottom-right
-         + to_string(static_cast<int>(target.size.Y * -1 + target.position.Y)) + " 0 0 " // corner coordinates to determine a rectangle
-         + to_string(static_cast<int>(target.width)) + (target.isFilled ? " f" : " N");
-    return !++ret;
+    out << "S " << static_cast<int>(target.position.X) << " " << static_cast<int>(target.position.Y) << " "
+        << static_cast<int>(target.size.X + target.position.X) << " "          // KiCad uses the top-left and bottom-right
+        << static_cast<int>(target.size.Y * -1 + target.position.Y) << " 0 0 " // corner coordinates to determine a rectangle
+        << static_cast<int>(target.width) << (target.isFilled ? " f" : " N") << '\n';
   }
   
-  string* KiCad_5_Deserializer::outputSchPolygon(const Schematic_Polygon& target) const
+  void KiCad_5_Deserializer::outputSchPolygon(const Schematic_Polygon& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    *ret += "P " + to_string(target.polylinePoints.size() + 1) + " 0 0 " + to_string(target.lineWidth) + " ";
+    out << "P " << target.polylinePoints.size() + 1 << " 0 0 " << target.lineWidth << " ";
     for(auto &i : target.polylinePoints)
-      *ret += to_string(static_cast<int>(i.X)) + " " + to_string(static_cast<int>(i.Y)) + " ";
+      out << static_cast<int>(i.X) << " " << static_cast<int>(i.Y) << " ";
     // For polygons they are represented in "P" as well but the last point is the same as the first point.
     // Point count is also incremented by 1.
-    *ret += to_string(static_cast<int>(target.polylinePoints[0].X)) + " " + to_string(static_cast<int>(target.polylinePoints[0].Y));
-    *ret += (target.isFilled ? " f" : " N");
-    return !++ret;
+    out << static_cast<int>(target.polylinePoints[0].X) << " " << static_cast<int>(target.polylinePoints[0].Y);
+    out << (target.isFilled ? " f" : " N") << '\n';
   }
 
-  string *KiCad_5_Deserializer::outputSchArc(const Schematic_Arc& target) const
+  void KiCad_5_Deserializer::outputSchArc(const Schematic_Arc& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
-    *ret += "A " + to_string(static_cast<int>(target.center.X)) + " " + to_string(static_cast<int>(target.center.Y)) + " "
-          + to_string(static_cast<int>(target.size.X)) + " "
-          + to_string(static_cast<int>(target.startAngle * 10)) + " " + to_string(static_cast<int>(target.endAngle * 10)) + " "
-            "0 1 "
-          + to_string(static_cast<int>(target.width)) + " " + (target.isFilled ? " f" : " N") + " "
-          + to_string(static_cast<int>(target.startPoint.X)) + " " + to_string(static_cast<int>(target.startPoint.Y)) + " "
-          + to_string(static_cast<int>(target.endPoint.X)) + " " + to_string(static_cast<int>(target.endPoint.Y)) + " ";
-    return !++ret;
+    out << "A " << static_cast<int>(target.center.X) << " " << static_cast<int>(target.center.Y) << " "
+        << static_cast<int>(target.size.X) << " "
+        << static_cast<int>(target.startAngle * 10) << " " << static_cast<int>(target.endAngle * 10) << " "
+           "0 1 "
+        << static_cast<int>(target.width) << " " << (target.isFilled ? " f" : " N") << " "
+        << static_cast<int>(target.startPoint.X) << " " << static_cast<int>(target.startPoint.Y) << " "
+        << static_cast<int>(target.endPoint.X) << " " << static_cast<int>(target.endPoint.Y) << " " << '\n';
   }
 
-  string* KiCad_5_Deserializer::outputSchText(const Schematic_Text& target) const
+  void KiCad_5_Deserializer::outputSchText(const Schematic_Text& target, OutputBuffer &out) const
   {
-    RAIIC<string> ret;
     Warn("KiCad_5_Deserializer::outputSchText stub. " + target.id + "is ignored.");
-    return !++ret;
+    out << '\n';
   }
 }
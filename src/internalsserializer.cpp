@@ -27,11 +27,22 @@
 #include <fstream>
 #include <cmath>
 #include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <exception>
+#include <memory>
+#include <thread>
 
 #include "includes.hpp"
+#include "logger.hpp"
 #include "rapidjson.hpp"
 #include "edaclasses.hpp"
+#include "bezier.hpp"
+#include "polygonsimplifier.hpp"
+#include "trackmerger.hpp"
 #include "smolsvg/pathreader.hpp"
+#include "streamreader.hpp"
 #include "internalsserializer.hpp"
 
 using std::cout;
@@ -39,8 +50,6 @@ using std::endl;
 using std::fstream;
 using std::string;
 using std::vector;
-using std::stod;
-using std::stoi;
 using std::to_string;
 using rapidjson::FileReadStream;
 using rapidjson::Document;
@@ -48,8 +57,11 @@ using rapidjson::Value;
 
 namespace lc2kicad
 {
-  void LCJSONSerializer::initWorkingDocument(EDADocument *_workingDocument) { workingDocument = _workingDocument; }
-  void LCJSONSerializer::deinitWorkingDocument() { workingDocument = nullptr; }
+  void LCJSONSerializer::initWorkingDocument(EDADocument *_workingDocument)
+  {
+    workingDocument = elementOwner = _workingDocument;
+  }
+  void LCJSONSerializer::deinitWorkingDocument() { workingDocument = elementOwner = nullptr; }
 
   void LCJSONSerializer::setCompatibilitySwitches(const str_dbl_map &aSwitches)
   {
@@ -68,6 +80,20 @@ namespace lc2kicad
 
     if(internalCompatibilitySwitches.count("ENL"))
      exportNestedLibs = true;
+
+    // Chord tolerance of curves in region outlines, given in micrometers and kept in EasyEDA units
+    auto tolerance = internalCompatibilitySwitches.find("CFT");
+    curveTolerance = (tolerance != internalCompatibilitySwitches.end() && tolerance->second > 0 ? tolerance->second : 1.0)
+                       / 1000.0 / tenmils_to_mm_coefficient;
+
+    // Flood fill and solid region simplification, on when given a tolerance (micrometers) or a vertex budget
+    double simplifyTolerance = internalCompatibilitySwitches.count("PST") ? internalCompatibilitySwitches["PST"] : 0,
+           vertexBudget = internalCompatibilitySwitches.count("PVB") ? internalCompatibilitySwitches["PVB"] : 0;
+    simplifyPolygons = simplifyTolerance > 0 || vertexBudget > 0;
+    polygonTolerance = simplifyTolerance > 0 ? simplifyTolerance / 1000.0 / tenmils_to_mm_coefficient : 0.0;
+    polygonVertexBudget = vertexBudget > 0 ? std::max(static_cast<size_t>(vertexBudget), static_cast<size_t>(3)) : 0;
+
+    mergeTracks = internalCompatibilitySwitches.count("MTS") && internalCompatibilitySwitches["MTS"] != 0;
   }
 
   LCJSONSerializer::~LCJSONSerializer() { };
@@ -77,8 +103,8 @@ namespace lc2kicad
     assertThrow(workingDocument->module, "Internal document type mismatch: Parse an internal document as symbol with its module property set to \"false\".");
     workingDocument->docType = documentTypes::schematic_lib;
 
-    Document &parseTarget = *workingDocument->jsonParseResult; // Create a reference for convenience.
-    vector<string> canvasPropertyList, shapesList;
+    Value &parseTarget = workingDocument->documentObject(); // Create a reference for convenience.
+    fieldList canvasPropertyList;
     string symbolName, contributor, prefix;
     str_str_map &docInfo = workingDocument->docInfo;
     Value shape, head;
@@ -86,9 +112,9 @@ namespace lc2kicad
     parseCommonDoucmentStructure(parseTarget, canvasPropertyList, shape, head);
 
     // Write canvas properties like origin and gridsize
-    workingDocument->origin.X = stod(canvasPropertyList[13]);
-    workingDocument->origin.Y = stod(canvasPropertyList[14]);
-    workingDocument->gridSize = stod(canvasPropertyList[6]);
+    workingDocument->origin.X = tolStod(canvasPropertyList[13]);
+    workingDocument->origin.Y = tolStod(canvasPropertyList[14]);
+    workingDocument->gridSize = tolStod(canvasPropertyList[6]);
     coordinates origin = workingDocument->origin;
 
     VERBOSE_INFO(string("Document origin X") + to_string(origin.X) + " Y" + to_string(origin.Y) + \
@@ -100,9 +126,6 @@ namespace lc2kicad
     Value &headlist = head["c_para"];
     symbolName = headlist.HasMember("name") ? headlist["name"].IsString() ? headlist["name"].GetString() : "" : "";\
 
-    for(unsigned int i = 0; i < shape.Size(); i++)
-      shapesList.push_back(shape[i].GetString());
-
     if(symbolName.size() != 0)
       docInfo["documentname"] = symbolName;
     prefix = headlist.HasMember("pre") ? headlist["pre"].IsString() ? headlist["pre"].GetString() : "U" : "U";
@@ -116,81 +139,85 @@ namespace lc2kicad
     docInfo["contributor"] = headlist.HasMember("Contributor") ? headlist["Contributor"].IsString() ?
                                    headlist["Contributor"].GetString() : "" : "" ;
 
-    parseSchLibComponent(shapesList, static_cast<Schematic_Module*>(workingDocument->containedElements.back())->containedElements);
+    vector<Schematic_Element*> &symbolElements =
+        static_cast<Schematic_Module*>(workingDocument->containedElements.back())->containedElements;
+    forEachShape(shape, [&](const fieldView &i) { parseSchShape(i, symbolElements); });
   }
 
-  void LCJSONSerializer::parseSchLibComponent(vector<string> &shapesList, vector<Schematic_Element*> &containedElements)
+  void LCJSONSerializer::parseSchLibComponent(vector<fieldView> &shapesList, vector<Schematic_Element*> &containedElements)
   {
     for(auto &i : shapesList)
+      parseSchShape(i, containedElements);
+  }
+
+  void LCJSONSerializer::parseSchShape(const fieldView &i, vector<Schematic_Element*> &containedElements)
+  {
+    switch(i[0])
     {
-      // vector<string> parameters = splitString(shapesList[i], '~');
-      switch(i[0])
-      {
-        case 'P':
-          switch(i[1])
-          {
-            case 'G': // Polygon
-              containedElements.push_back(parseSchPolygon(i));
-              break;
-            case 'I': // Pie
-              break;
-            case 'L': // Polyline
-              containedElements.push_back(parseSchPolyline(i));
-              break;
-            case 'T': // Path
-              break;
-            case 'i': // ImageInTheGrid
-              break;
-            default: // Pin
-              containedElements.push_back(parseSchPin(i));
-              break;
-          }
-          break;
-        case 'R': // Rectangle
-          containedElements.push_back(parseSchRect(i));
-          break;
-        case 'A':
-          switch(i[1])
-          {
-            case 'R': // Arrowhead
-              break;
-            default: // Arc
-              containedElements.push_back(parseSchArc(i));
-              break;
-          }
-          break;
-        case 'B':
-          switch(i[1])
-          {
-            case 'E': // Bus Entry
-              break;
-            default: // Bus
-              break;
-          }
-          break;
-        case 'I': // Image
-          break;
-        case 'L': // Line
-          break;
-        case 'C': // Circle
-          break;
-        case 'E': // Ellipse
-          break;
-        case 'T': // Annotations
-          break;
-        case 'N': // Netlabels
-          break;
-        case 'F': // Netflags (Netports)
-          break;
-        case 'W': // Wire
-          break;
-        case 'J': // Junction
-          break;
-        case 'O': // No Connect Flag
-          break;
-        default:
-          assertThrow(false, "Invalid element string <<<" + i + ">>>.");
-      }
+      case 'P':
+        switch(i[1])
+        {
+          case 'G': // Polygon
+            containedElements.push_back(parseSchPolygon(fieldList(i, '~')));
+            break;
+          case 'I': // Pie
+            break;
+          case 'L': // Polyline
+            containedElements.push_back(parseSchPolyline(fieldList(i, '~')));
+            break;
+          case 'T': // Path
+            break;
+          case 'i': // ImageInTheGrid
+            break;
+          default: // Pin
+            containedElements.push_back(parseSchPin(i));
+            break;
+        }
+        break;
+      case 'R': // Rectangle
+        containedElements.push_back(parseSchRect(fieldList(i, '~')));
+        break;
+      case 'A':
+        switch(i[1])
+        {
+          case 'R': // Arrowhead
+            break;
+          default: // Arc
+            containedElements.push_back(parseSchArc(fieldList(i, '~')));
+            break;
+        }
+        break;
+      case 'B':
+        switch(i[1])
+        {
+          case 'E': // Bus Entry
+            break;
+          default: // Bus
+            break;
+        }
+        break;
+      case 'I': // Image
+        break;
+      case 'L': // Line
+        break;
+      case 'C': // Circle
+        break;
+      case 'E': // Ellipse
+        break;
+      case 'T': // Annotations
+        break;
+      case 'N': // Netlabels
+        break;
+      case 'F': // Netflags (Netports)
+        break;
+      case 'W': // Wire
+        break;
+      case 'J': // Junction
+        break;
+      case 'O': // No Connect Flag
+        break;
+      default:
+        assertThrow(false, "Invalid element string <<<" + i + ">>>.");
     }
   }
 
@@ -199,8 +226,8 @@ namespace lc2kicad
     assertThrow(!workingDocument->module, "Internal document type mismatch: Parse an internal document as PCB with its module property set to \"true\".");
     workingDocument->docType = documentTypes::pcb;
 
-    Document &parseTarget = *workingDocument->jsonParseResult; // Create a reference for convenience.
-    vector<string> canvasPropertyList, shapesList;
+    Value &parseTarget = workingDocument->documentObject(); // Create a reference for convenience.
+    fieldList canvasPropertyList;
     vector<int> layerMapper;
     string footprintName, contributor;
     str_str_map &docInfo = workingDocument->docInfo;
@@ -211,20 +238,225 @@ namespace lc2kicad
     parseCommonDoucmentStructure(parseTarget, canvasPropertyList, shape, head);
 
     // Write canvas properties like origin and gridsize
-    workingDocument->origin.X = stod(canvasPropertyList[16]);
-    workingDocument->origin.Y = stod(canvasPropertyList[17]);
-    workingDocument->gridSize = stod(canvasPropertyList[6]);
+    workingDocument->origin.X = tolStod(canvasPropertyList[16]);
+    workingDocument->origin.Y = tolStod(canvasPropertyList[17]);
+    workingDocument->gridSize = tolStod(canvasPropertyList[6]);
     coordinates origin = workingDocument->origin;
 
     VERBOSE_INFO(string("Document origin X") + to_string(origin.X) + " Y" + to_string(origin.Y) + \
           ", grid size " + to_string(workingDocument->gridSize));
 
-    for(unsigned int i = 0; i < shape.Size(); i++)
-      shapesList.push_back(shape[i].GetString());
+    PCBDocument *document = static_cast<PCBDocument*>(workingDocument);
+    pcbShapeContext context { document, origin, false };
+    unsigned int parseThreads = parallelParseThreads();
+    if(parseThreads && !shapeStream)
+    {
+      vector<fieldView> shapesList;
+      shapesList.reserve(shape.Size());
+      forEachShape(shape, [&](const fieldView &i) { shapesList.push_back(i); });
+      parsePCBShapesParallel(context, shapesList, document->containedElements, parseThreads);
+    }
+    else
+      forEachShape(shape, [&](const fieldView &i) { parsePCBShape(context, i, document->containedElements); });
+    document->resolveParsedShapes();
+    reportPolygonSimplification(document);
+
+    if(mergeTracks)
+    {
+      trackMergeResult merged = mergePCBTracks(*document);
+      Info("Tracks were merged from " + to_string(merged.segmentsBefore) + " to " + to_string(merged.segmentsAfter) +
+           " segments.");
+    }
+  }
+
+  pointRange LCJSONSerializer::endPolygonRange(const pcbShapeContext &context, size_t firstPoint) const
+  {
+    PointPool &points = context.owner->pointPool;
+    if(simplifyPolygons)
+    {
+      size_t count = points.size() - firstPoint,
+             kept = simplifyPolygon(points.dataX(firstPoint), points.dataY(firstPoint), count, polygonTolerance,
+                                    polygonVertexBudget);
+      points.truncate(firstPoint + kept);
+      context.owner->polygonVerticesRead += count;
+      context.owner->polygonVerticesKept += kept;
+    }
+    return points.endRange(firstPoint);
+  }
+
+  void LCJSONSerializer::reportPolygonSimplification(const PCBDocument *document) const
+  {
+    if(simplifyPolygons)
+      Info("Flood fills and solid regions were simplified from " + to_string(document->polygonVerticesRead) +
+           " to " + to_string(document->polygonVerticesKept) + " vertices.");
+  }
+
+  unsigned int LCJSONSerializer::parallelParseThreads() const
+  {
+    auto found = internalCompatibilitySwitches.find("PSP");
+    return found != internalCompatibilitySwitches.end() && found->second > 1 ?
+             static_cast<unsigned int>(found->second) : 0;
+  }
+
+  namespace
+  {
+    /**
+     * Read an SVG path into a buffer kept per thread, so its storage is reused from one shape to the next.
+     * The buffer is only valid until the next call on the same thread.
+     */
+    const SmolSVG::pathBuffer &readSVGPath(const fieldView &pathString, const string &id)
+    {
+      thread_local SmolSVG::pathBuffer path;
+      SmolSVG::pathError error = SmolSVG::readPath(pathString.begin(), pathString.end(), path);
+      assertThrow(error == SmolSVG::pathError::none, id + ": Invalid SVG path (" + SmolSVG::pathErrorMessage(error) + ").");
+      return path;
+    }
+
+    // Read an SVG path and return its last segment, which must be an elliptical arc.
+    const SmolSVG::pathBuffer::segment &readSVGArc(const fieldView &pathString, const string &id,
+                                                   const SmolSVG::pathBuffer *&path)
+    {
+      path = &readSVGPath(pathString, id);
+      assertThrow(!path->empty() && path->back().type == SmolSVG::ArcTo, id + ": Path of arc doesn't end with an arc.");
+      return path->back();
+    }
+
+    // Read the path of an ARC and queue it on the document for resolveParsedShapes()
+    void queuePCBArc(const pcbShapeContext &context, const fieldView &pathString, PCB_GraphicalArc *result)
+    {
+      const SmolSVG::pathBuffer *path;
+      const SmolSVG::pathBuffer::segment &arc = readSVGArc(pathString, result->id, path);
+      const SmolSVG::SmolCoord &start = path->startPoint(arc), &end = path->endPoint(arc), &radii = path->radii(arc);
+      context.owner->pendingArcs.add(start.X, start.Y, radii.X, radii.Y, arc.XAxisRotation, arc.largeArc, arc.sweep,
+                                     end.X, end.Y);
+      context.owner->pendingArcElements.emplace_back(result, context.origin);
+    }
+
+    /**
+     * Run task(0) to task(count - 1) on up to threadCount threads, each taking the next index when it's
+     * done with the last. Once an index throws no more get handed out, and after all threads are done the
+     * exception of the lowest index is rethrown.
+     */
+    void runParallel(size_t count, unsigned int threadCount, const std::function<void(size_t)> &task)
+    {
+      if(!count)
+        return;
+
+      std::atomic<size_t> next(0);
+      vector<std::exception_ptr> exceptions(count);
+      string context = logContext();
+
+      auto worker = [&]()
+      {
+        setLogContext(context);
+        for(size_t index; (index = next++) < count; )
+          try { task(index); }
+          catch(...)
+          {
+            exceptions[index] = std::current_exception();
+            next = count;
+          }
+        // Queued messages are written out as the thread ends; repeat groups go on until the caller's flushLog()
+      };
+
+      setLogContext(context); // Write out what's queued so far before the workers' messages
+      vector<std::thread> threads;
+      threads.reserve(threadCount);
+      for(size_t i = 0; i < std::min<size_t>(threadCount, count); i++)
+        threads.emplace_back(worker);
+      for(auto &i : threads)
+        i.join();
+
+      for(auto &i : exceptions)
+        if(i)
+          std::rethrow_exception(i);
+    }
+
+    // Give a net-bearing element (and the pads of a module) the code of its net in the target document
+    void importElementNets(EDAElement *element, PCBNetManager &target, const PCBNetManager &source,
+                           vector<PCBNet> &codeMap)
+    {
+      PCBNet *net;
+      switch(element->kind)
+      {
+        case PCBModule:
+          for(auto &i : static_cast<PCB_Module*>(element)->containedElements)
+            importElementNets(i, target, source, codeMap);
+          return;
+        case PCBPad: net = &static_cast<PCB_Pad*>(element)->net; break;
+        case PCBCopperTrack: net = &static_cast<PCB_CopperTrack*>(element)->net; break;
+        case PCBVia: net = &static_cast<PCB_Via*>(element)->net; break;
+        case PCBCopperSolidRegion: net = &static_cast<PCB_CopperSolidRegion*>(element)->net; break;
+        case PCBFloodFill: net = &static_cast<PCB_FloodFill*>(element)->net; break;
+        case PCBCopperCircle: net = &static_cast<PCB_CopperCircle*>(element)->net; break;
+        case PCBCopperArc: net = &static_cast<PCB_CopperArc*>(element)->net; break;
+        default: return;
+      }
+
+      if(codeMap.size() <= *net)
+        codeMap.resize(*net + 1, UINT_MAX);
+      if(codeMap[*net] == UINT_MAX)
+        codeMap[*net] = target.importNet(source, *net);
+      *net = codeMap[*net];
+    }
+  }
+
+  /**
+   * Parse PCB shapes on several threads. The list is cut into chunks of about the same length of shape
+   * strings, which is what parsing time goes with (a chunk of footprints holds fewer shapes than one of
+   * tracks). Every chunk is parsed into a document of its own (a shard), so nothing is shared while
+   * parsing. Chunks are then appended in order, and the nets of their elements are looked up in the
+   * context's document in that order, which numbers nets just like a serial parse.
+   */
+  void LCJSONSerializer::parsePCBShapesParallel(const pcbShapeContext &context, vector<fieldView> &shapesList,
+                                                vector<EDAElement*> &containedElements, unsigned int threadCount) const
+  {
+    vector<size_t> chunkStarts { 0 };
+    size_t chunkLength = 0;
+    for(size_t i = 0; i + 1 < shapesList.size(); i++)
+      if((chunkLength += shapesList[i].size()) >= parallelChunkLength)
+      {
+        chunkStarts.push_back(i + 1);
+        chunkLength = 0;
+      }
+    chunkStarts.push_back(shapesList.size());
 
-    parsePCBLibComponent(shapesList, workingDocument->containedElements);
+    if(chunkStarts.size() < 3) // Just one chunk, no use for threads
+    {
+      parsePCBLibComponent(context, shapesList, containedElements);
+      return;
+    }
 
+    struct chunk
+    {
+      std::unique_ptr<PCBDocument> shard;
+      vector<EDAElement*> elements;
+    };
+    vector<chunk> chunks(chunkStarts.size() - 1);
 
+    runParallel(chunks.size(), threadCount, [&](size_t index)
+    {
+      chunk &current = chunks[index];
+      current.shard.reset(new PCBDocument());
+      pcbShapeContext shardContext { current.shard.get(), context.origin, context.inModule };
+      for(size_t i = chunkStarts[index]; i < chunkStarts[index + 1]; i++)
+        parsePCBShape(shardContext, shapesList[i], current.elements);
+      current.shard->resolveParsedShapes();
+    });
+
+    for(auto &i : chunks)
+    {
+      vector<PCBNet> codeMap;
+      for(auto &j : i.elements)
+      {
+        importElementNets(j, context.owner->netManager, i.shard->netManager, codeMap);
+        containedElements.push_back(j);
+      }
+      context.owner->fillPriorityManager.merge(i.shard->fillPriorityManager);
+      context.owner->polygonVerticesRead += i.shard->polygonVerticesRead;
+      context.owner->polygonVerticesKept += i.shard->polygonVerticesKept;
+      context.owner->parseShards.push_back(std::move(i.shard));
+    }
   }
 
   void LCJSONSerializer::parsePCBLibDocument()
@@ -232,8 +464,8 @@ namespace lc2kicad
     assertThrow(workingDocument->module, "Internal document type mismatch: Parse an internal document as footprint with its module property set to \"false\".");
     workingDocument->docType = documentTypes::pcb_lib;
 
-    Document &parseTarget = *workingDocument->jsonParseResult; // Create a reference for convenience.
-    vector<string> canvasPropertyList, shapesList;
+    Value &parseTarget = workingDocument->documentObject(); // Create a reference for convenience.
+    fieldList canvasPropertyList;
     vector<int> layerMapper;
     string footprintName, contributor;
     str_str_map &docInfo = workingDocument->docInfo;
@@ -242,9 +474,9 @@ namespace lc2kicad
     parseCommonDoucmentStructure(parseTarget, canvasPropertyList, shape, head);
 
     // Write canvas properties like origin and gridsize
-    workingDocument->origin.X = stod(canvasPropertyList[16]);
-    workingDocument->origin.Y = stod(canvasPropertyList[17]);
-    workingDocument->gridSize = stod(canvasPropertyList[6]);
+    workingDocument->origin.X = tolStod(canvasPropertyList[16]);
+    workingDocument->origin.Y = tolStod(canvasPropertyList[17]);
+    workingDocument->gridSize = tolStod(canvasPropertyList[6]);
     coordinates origin = workingDocument->origin;
 
     VERBOSE_INFO(string("Document origin X") + to_string(origin.X) + " Y" + to_string(origin.Y) + \
@@ -260,74 +492,88 @@ namespace lc2kicad
                       "" :
                     "";
 
-    for(unsigned int i = 0; i < shape.Size(); i++)
-      shapesList.push_back(shape[i].GetString());
-
     if(footprintName.size() != 0)
       docInfo["documentname"] = footprintName;
     docInfo["contributor"] = headlist.HasMember("Contributor") ? headlist["Contributor"].IsString() ?
                                    headlist["Contributor"].GetString() : "" : "";
 
-    processingModule = true;
+    pcbShapeContext context { static_cast<PCBDocument*>(workingDocument), origin, true };
+    vector<EDAElement*> &footprintElements =
+        static_cast<PCB_Module*>(workingDocument->containedElements.back())->containedElements;
+    forEachShape(shape, [&](const fieldView &i) { parsePCBShape(context, i, footprintElements); });
+    context.owner->resolveParsedShapes();
+    reportPolygonSimplification(context.owner);
+  }
 
-    parsePCBLibComponent(shapesList, static_cast<PCB_Module*>(workingDocument->containedElements.back())->containedElements);
+  bool nestedLibraryCache::isDuplicate(const fieldView &uuid, const fieldView &id) const
+  {
+    if(!uuids.count(uuid.str()))
+      return false;
+    VERBOSE_INFO("Library of " + id + " skipped, one with UUID " + uuid + " was already taken out.");
+    return true;
+  }
 
-    processingModule = false;
+  void nestedLibraryCache::add(const fieldView &uuid, string &name, const string &id)
+  {
+    uuids.insert(uuid.str());
+    if(names.count(name))
+    { // If found that there's a component with the same name but they aren't actually the same one (which is tested possible)
+      Info("More than one footprint on this board was found called <<<" + name + ">>>(" +
+         id + "), gID will be added to the name.");
+      name += ("__" + id); // Modify the name for clarification
+    }
+    names.insert(name);
   }
 
   list<EDADocument*> LCJSONSerializer::parseSchNestedLibs()
   {
     assertThrow(!workingDocument->module, "Internal document type mismatch: Parse an internal document as schematics with its module property set to \"true\".");
     workingDocument->docType = schematic;
-    map<string, RAIIC<EDADocument>> prepareList; // UUID<->Component pair
+    nestedLibraryCache prepareList;
     list<EDADocument*> ret;
-    stringlist canvasPropertyList;
+    fieldList canvasPropertyList;
     Value shape, head;
 
-    Document &parseTarget = *workingDocument->jsonParseResult; // Create a reference for convenience.
+    Value &parseTarget = workingDocument->documentObject(); // Create a reference for convenience.
 
     parseCommonDoucmentStructure(parseTarget, canvasPropertyList, shape, head);
 
     // Write canvas properties like origin and gridsize
-    workingDocument->origin.X = stod(canvasPropertyList[13]);
-    workingDocument->origin.Y = stod(canvasPropertyList[14]);
-    workingDocument->gridSize = stod(canvasPropertyList[10]);
+    workingDocument->origin.X = tolStod(canvasPropertyList[13]);
+    workingDocument->origin.Y = tolStod(canvasPropertyList[14]);
+    workingDocument->gridSize = tolStod(canvasPropertyList[10]);
     coordinates origin = workingDocument->origin;
 
     VERBOSE_INFO(string("SchSheet origin X") + to_string(origin.X) + " Y" + to_string(origin.Y) + \
           ", grid size " + to_string(workingDocument->gridSize));
 
-    stringlist shapesList;
-    string shapeStringTmp;
-    for(unsigned int i = 0; i < shape.Size(); i++)
+    forEachShape(shape, [&](const fieldView &i)
     {
-      shapeStringTmp = shape[i].GetString();
-      if(shapeStringTmp.find("LIB~", 0, 4) == 0) // Get all shapes begin with "LIB~"
-        shapesList.push_back(shapeStringTmp);
-    }
+      if(!i.startsWith("LIB~")) // Only take shapes begin with "LIB~"
+        return;
 
-    for(auto &i : shapesList)
-    {
       RAIIC<EDADocument> t;
       t->origin = origin;
       t->module = true;
-      RAIIC<Schematic_Module> m = parseSchModuleString(i, !t, &prepareList); // Try parse module without knowing if identical ones were processed
-      if(!m) // If there is an identical one then m is nullptr and both RAIIC managed memory blocks will be cleared out.
+      elementOwner = !t; // Library documents own their modules
+      Schematic_Module *m = parseSchModuleString(i, !t, &prepareList); // Try parse module without knowing if identical ones were processed
+      elementOwner = workingDocument;
+      if(m) // If there is an identical one then m is nullptr, and t is released along with what was parsed into it.
       {
         VERBOSE_INFO("SchNestedLib ID=" + m->uuid);
-        t->containedElements.push_back(!++m); // Protect the module and push it back into Document
-        prepareList[static_cast<Schematic_Module*>((!t)->containedElements.back())->uuid] = --t; // operator-- on RAIIC means one destruction will be ignored.
+        t->containedElements.push_back(m);
+        prepareList.documents.emplace(static_cast<Schematic_Module*>((!t)->containedElements.back())->uuid, --t); // operator-- on RAIIC means one destruction will be ignored.
       }
-    }
+    });
 
-    for(auto &i : prepareList)
+    for(auto &i : prepareList.documents)
     {
       ret.push_back(!++(i.second));
       EDADocument *doc = ret.back();
-      map<string, string> &cpara = static_cast<Schematic_Module*>(doc->containedElements.back())->cparaContent;
+      const cparaMap &cpara = static_cast<Schematic_Module*>(doc->containedElements.back())->cparaContent;
       doc->docInfo["documentname"] = static_cast<Schematic_Module*>(doc->containedElements.back())->name;
-      doc->docInfo["contributor"] = cpara["contributor"];
-      doc->docInfo["prefix"] = cpara["spicePre"]; // TODO: Proper prefix? But we would assume spicePre is identical with normal prefix
+      doc->docInfo["contributor"] = cpara[doc->stringPool.intern("contributor")];
+      doc->docInfo["prefix"] = cpara[doc->stringPool.intern("spicePre")]; // TODO: Proper prefix? But we would assume spicePre is identical with normal prefix
       doc->pathToFile = workingDocument->pathToFile + "__" + doc->docInfo["documentname"];
       doc->docType = schematic_lib;
     }
@@ -339,55 +585,80 @@ namespace lc2kicad
   {
     assertThrow(!workingDocument->module, "Internal document type mismatch: Parse an internal document as PCB with its module property set to \"true\".");
     workingDocument->docType = pcb;
-    map<string, RAIIC<EDADocument>> prepareList; // UUID<->Component pair
+    nestedLibraryCache prepareList;
     list<EDADocument*> ret;
-    stringlist canvasPropertyList;
+    fieldList canvasPropertyList;
     Value shape, head;
 
-    Document &parseTarget = *workingDocument->jsonParseResult; // Create a reference for convenience.
+    Value &parseTarget = workingDocument->documentObject(); // Create a reference for convenience.
 
     parseCommonDoucmentStructure(parseTarget, canvasPropertyList, shape, head);
 
     // Write canvas properties like origin and gridsize
-    workingDocument->origin.X = stod(canvasPropertyList[16]);
-    workingDocument->origin.Y = stod(canvasPropertyList[17]);
-    workingDocument->gridSize = stod(canvasPropertyList[6]);
+    workingDocument->origin.X = tolStod(canvasPropertyList[16]);
+    workingDocument->origin.Y = tolStod(canvasPropertyList[17]);
+    workingDocument->gridSize = tolStod(canvasPropertyList[6]);
     coordinates origin = workingDocument->origin;
 
     VERBOSE_INFO(string("Document origin X") + to_string(origin.X) + " Y" + to_string(origin.Y) + \
           ", grid size " + to_string(workingDocument->gridSize));
 
-    stringlist shapesList;
-    string shapeStringTmp;
-    for(unsigned int i = 0; i < shape.Size(); i++)
+    /**
+     * Components are taken out in document order, but only their headers, which is all it takes to tell
+     * duplicates apart. Their shapes are parsed afterwards, each into its own document, so that can go on
+     * several threads. Shapes from a stream are gone after the callback and get parsed right away.
+     */
+    struct pendingLibrary
     {
-      shapeStringTmp = shape[i].GetString();
-      if(shapeStringTmp.find("LIB~", 0, 4) == 0) // Get all shapes begin with "LIB~"
-        shapesList.push_back(shapeStringTmp);
-    }
-
-    for(auto &i : shapesList)
+      pcbShapeContext context;
+      fieldView shapesString;
+      PCB_Module *module;
+    };
+    vector<pendingLibrary> pendingLibraries;
+    unsigned int parseThreads = shapeStream ? 0 : parallelParseThreads();
+
+    forEachShape(shape, [&](const fieldView &i)
     {
-      RAIIC<EDADocument> t;
+      if(!i.startsWith("LIB~")) // Only take shapes begin with "LIB~"
+        return;
+
+      RAIIC<EDADocument> t(new PCBDocument); // Holds the nets of its pads too
       t->origin = origin;
       t->module = true;
-      RAIIC<PCB_Module> m = parsePCBModuleString(i, !t, &prepareList); // Try parse module without knowing if identical ones were processed
-      if(!m) // If there is an identical one then m is nullptr and both RAIIC managed memory blocks will be cleared out.
+      pendingLibrary library;
+      // Try parse module without knowing if identical ones were processed
+      library.module = parsePCBModuleHeader({ static_cast<PCBDocument*>(!t), origin, false }, i, &prepareList,
+                                            library.context, library.shapesString);
+      if(library.module) // If there is an identical one then it's nullptr, and t is released along with what was parsed into it.
       {
-        t->containedElements.push_back(!++m); // Protect the module and push it back into Document
-        prepareList[static_cast<PCB_Module*>((!t)->containedElements.back())->uuid] = --t; // operator-- on RAIIC means one destruction will be ignored.
+        if(parseThreads)
+          pendingLibraries.push_back(library);
+        else
+        {
+          parsePCBModuleShapes(library.context, library.shapesString, library.module);
+          library.context.owner->resolveParsedShapes();
+        }
+        t->containedElements.push_back(library.module);
+        prepareList.documents.emplace(library.module->uuid, --t); // operator-- on RAIIC means one destruction will be ignored.
       }
-    }
+    });
+
+    runParallel(pendingLibraries.size(), parseThreads, [&](size_t index)
+    {
+      pendingLibrary &library = pendingLibraries[index];
+      parsePCBModuleShapes(library.context, library.shapesString, library.module);
+      library.context.owner->resolveParsedShapes();
+    });
 
-    // When we got errors of any kind, RAIIC will handle the dynamic memory. Now we're not errored out,
+    // When we got errors of any kind, RAIIC and the arenas will handle the dynamic memory. Now we're not errored out,
     // so we move everything into a retval vector and process misc stuff.
-    for(auto &i : prepareList)
+    for(auto &i : prepareList.documents)
     {
       ret.push_back(!++(i.second));
       EDADocument *doc = ret.back();
-      map<string, string> &cpara = static_cast<PCB_Module*>(doc->containedElements.back())->cparaContent;
+      const cparaMap &cpara = static_cast<PCB_Module*>(doc->containedElements.back())->cparaContent;
       doc->docInfo["documentname"] = static_cast<PCB_Module*>(doc->containedElements.back())->name;
-      doc->docInfo["contributor"] = cpara["contributor"];
+      doc->docInfo["contributor"] = cpara[doc->stringPool.intern("contributor")];
       doc->pathToFile = workingDocument->pathToFile + "__" + doc->docInfo["documentname"];
       doc->docType = pcb_lib;
     }
@@ -395,144 +666,153 @@ namespace lc2kicad
     return ret;
   }
 
-  void LCJSONSerializer::parsePCBLibComponent(vector<string> &shapesList, vector<EDAElement*> &containedElements)
+  void LCJSONSerializer::parsePCBLibComponent(const pcbShapeContext &context, vector<fieldView> &shapesList,
+                                              vector<EDAElement*> &containedElements) const
   {
     for(auto &i : shapesList)
+      parsePCBShape(context, i, containedElements);
+  }
+
+  void LCJSONSerializer::parsePCBShape(const pcbShapeContext &context, const fieldView &i,
+                                       vector<EDAElement*> &containedElements) const
+  {
+    switch(i[0])
     {
-      // vector<string> parameters = splitString(shapesList[i], '~');
-      switch(i[0])
-      {
-        case 'P':
-          switch(i[1])
+      case 'P':
+        switch(i[1])
+        {
+          case 'A': // Pad
+            if(context.inModule)
+              containedElements.push_back(parsePCBPadString(context, fieldList(i, '~')));
+            else
+              containedElements.push_back(parsePCBDiscretePadString(context, fieldList(i, '~')));
+            break;
+          case 'R': // Protractor
+            break;
+          case 'L': // PlanarZone (negative)
+            containedElements.push_back(parsePCBPlaneZoneString(context, i));
+            break;
+          default:
+            Error("Invalid element string <<<" + i + ">>>.");
+        }
+        break;
+      case 'T':
+        switch(i[1])
+        {
+          case 'E': // Text
+            containedElements.push_back(parsePCBTextString(context, fieldList(i, '~')));
+            break;
+          case 'R': // Track
           {
-            case 'A': // Pad
-              if(processingModule)
-                containedElements.push_back(parsePCBPadString(i));
-              else
-                containedElements.push_back(parsePCBDiscretePadString(i));
-              break;
-            case 'R': // Protractor
-              break;
-            case 'L': // PlanarZone (negative)
-              containedElements.push_back(parsePCBPlaneZoneString(i));
-              break;
-            default:
-              Error("Invalid element string <<<" + i + ">>>.");
+            fieldList paramList(i, '~');
+            if(EasyEdaToKiCadLayerMap.isCopper(tolStoi(paramList[2])))
+              containedElements.push_back(parsePCBCopperTrackString(context, paramList));
+            else
+              containedElements.push_back(parsePCBGraphicalTrackString(context, paramList));
+            break;
           }
-          break;
-        case 'T':
-          switch(i[1])
-          {
-            case 'E': // Text
-              containedElements.push_back(parsePCBTextString(i));
-              break;
-            case 'R': // Track
-            {
-              stringlist tmp = splitString(i, '~');
-              if(judgeIsOnCopperLayer(EasyEdaToKiCadLayerMap[stoi(loadNthSeparated(i, '~', 2))]))
-                containedElements.push_back(parsePCBCopperTrackString(i));
-              else
-                containedElements.push_back(parsePCBGraphicalTrackString(i));
-              break;
-            }
-            default:
-              Error("Invalid element string <<<" + i + ">>>.");
-          }
-          break;
-        case 'C':
-          switch(i[1])
+          default:
+            Error("Invalid element string <<<" + i + ">>>.");
+        }
+        break;
+      case 'C':
+        switch(i[1])
+        {
+          case 'O': // CopperArea
+            containedElements.push_back(parsePCBFloodFillString(context, fieldList(i, '~')));
+            break;
+          case 'I': // Circle
           {
-            case 'O': // CopperArea
-              containedElements.push_back(parsePCBFloodFillString(i));
-              break;
-            case 'I': // Circle
-              if(judgeIsOnCopperLayer(EasyEdaToKiCadLayerMap[stoi(loadNthSeparated(i, '~', 5))]))
-                containedElements.push_back(parsePCBCopperCircleString(i));
-              else
-                containedElements.push_back(parsePCBGraphicalCircleString(i));
-              break;
-            default:
-              Error("Invalid element string <<<" + i + ">>>.");
+            fieldList paramList(i, '~');
+            if(EasyEdaToKiCadLayerMap.isCopper(tolStoi(paramList[5])))
+              containedElements.push_back(parsePCBCopperCircleString(context, paramList));
+            else
+              containedElements.push_back(parsePCBGraphicalCircleString(context, paramList));
+            break;
           }
-          break;
-        case 'R': // Rect
-          containedElements.push_back(parsePCBRectString(i));
-          break;
-        case 'A': // Arc
-        {
-          if(judgeIsOnCopperLayer(EasyEdaToKiCadLayerMap[stoi(loadNthSeparated(i, '~', 2))]))
-            containedElements.push_back(parsePCBCopperArcString(i));
-          else
-            containedElements.push_back(parsePCBGraphicalArcString(i));
-          break;
+          default:
+            Error("Invalid element string <<<" + i + ">>>.");
         }
-        case 'V': // Via
-          containedElements.push_back(parsePCBViaString(i));
-          break;
-        case 'H': // Hole
-          containedElements.push_back(parsePCBHoleString(i));
-          break;
-        case 'D': // Dimension
-          break;
-        case 'S':
+        break;
+      case 'R': // Rect
+        containedElements.push_back(parsePCBRectString(context, fieldList(i, '~')));
+        break;
+      case 'A': // Arc
+      {
+        fieldList paramList(i, '~');
+        if(EasyEdaToKiCadLayerMap.isCopper(tolStoi(paramList[2])))
+          containedElements.push_back(parsePCBCopperArcString(context, paramList));
+        else
+          containedElements.push_back(parsePCBGraphicalArcString(context, paramList));
+        break;
+      }
+      case 'V': // Via
+        containedElements.push_back(parsePCBViaString(context, fieldList(i, '~')));
+        break;
+      case 'H': // Hole
+        containedElements.push_back(parsePCBHoleString(context, fieldList(i, '~')));
+        break;
+      case 'D': // Dimension
+        break;
+      case 'S':
+      {
+        switch(i[1])
         {
-          switch(i[1])
+          case 'V': // SVGNODE
+            // Discarding SVGNODE objects usually doesn't result in broken boards,
+            // therefore I decided to move it into verbose info.
+            VERBOSE_INFO("An SVGNODE object has been discarded.");
+            break;
+          case 'O': // Solidregion
           {
-            case 'V': // SVGNODE
-              // Discarding SVGNODE objects usually doesn't result in broken boards,
-              // therefore I decided to move it into verbose info.
-              VERBOSE_INFO("An SVGNODE object has been discarded.");
-              break;
-            case 'O': // Solidregion
-              if(!processingModule)
-              {
-                auto type = loadNthSeparated(i, '~', 4);
-                if(type == "solid")
-                  if(judgeIsOnCopperLayer(EasyEdaToKiCadLayerMap[stoi(loadNthSeparated(i, '~', 1))]))
-                    containedElements.push_back(parsePCBCopperSolidRegionString(i));
-                  else
-                    containedElements.push_back(parsePCBGraphicalSolidRegionString(i));
-                else if(type == "npth")
-                  containedElements.push_back(parsePCBNpthRegionString(i));
-                else if(type == "cutout")
-                  containedElements.push_back(parsePCBKeepoutRegionString(i));
-              }
-              else
-              {
-
-                auto type = loadNthSeparated(i, '~', 4);
-                if(type == "solid")
-                  if(!judgeIsOnCopperLayer(EasyEdaToKiCadLayerMap[stoi(loadNthSeparated(i, '~', 1))]))
-                    containedElements.push_back(parsePCBGraphicalSolidRegionString(i));
-                  else
-                    Warn(loadNthSeparated(i, '~', 5) +
-                         ": A copper region was found inside a footprint, which is not allowed in KiCad. "
-                         "This region is discarded!");
-                else if(type == "npth")
-                  containedElements.push_back(parsePCBNpthRegionString(i));
-                else if(type == "cutout")
-                  containedElements.push_back(parsePCBKeepoutRegionString(i));
-                // Can we move the region into main board? Probably not, cause we can't.
-                // That's how LC2KiCad was constructed. You can't put an element into board,
-                // because we can only see the containedElements of the footprint in this function.
-              }
-              break;
-            default:
-              Error("Invalid element string <<<" + i + ">>>.");
+            fieldList paramList(i, '~');
+            fieldView type = paramList[4];
+            if(!context.inModule)
+            {
+              if(type == "solid")
+                if(EasyEdaToKiCadLayerMap.isCopper(tolStoi(paramList[1])))
+                  containedElements.push_back(parsePCBCopperSolidRegionString(context, paramList));
+                else
+                  containedElements.push_back(parsePCBGraphicalSolidRegionString(context, paramList));
+              else if(type == "npth")
+                containedElements.push_back(parsePCBNpthRegionString(context, paramList));
+              else if(type == "cutout")
+                containedElements.push_back(parsePCBKeepoutRegionString(context, paramList));
+            }
+            else
+            {
+              if(type == "solid")
+                if(!EasyEdaToKiCadLayerMap.isCopper(tolStoi(paramList[1])))
+                  containedElements.push_back(parsePCBGraphicalSolidRegionString(context, paramList));
+                else
+                  Warn(paramList[5].str() +
+                       ": A copper region was found inside a footprint, which is not allowed in KiCad. "
+                       "This region is discarded!");
+              else if(type == "npth")
+                containedElements.push_back(parsePCBNpthRegionString(context, paramList));
+              else if(type == "cutout")
+                containedElements.push_back(parsePCBKeepoutRegionString(context, paramList));
+              // Can we move the region into main board? Probably not, cause we can't.
+              // That's how LC2KiCad was constructed. You can't put an element into board,
+              // because we can only see the containedElements of the footprint in this function.
+            }
+            break;
           }
-          break;
+          default:
+            Error("Invalid element string <<<" + i + ">>>.");
         }
-        case 'L': // Footprint
-          containedElements.push_back(parsePCBModuleString(i));
-          break;
-        default:
-          assertThrow(false, "Invalid element string <<<" + i + ">>>.");
+        break;
       }
+      case 'L': // Footprint
+        containedElements.push_back(parsePCBModuleString(context, i));
+        break;
+      default:
+        assertThrow(false, "Invalid element string <<<" + i + ">>>.");
     }
   }
 
-  void LCJSONSerializer::parseCommonDoucmentStructure(rapidjson::Document &parseTarget,
-                            std::vector<std::string> &canvasPropertyList,
+  void LCJSONSerializer::parseCommonDoucmentStructure(rapidjson::Value &parseTarget,
+                            fieldList &canvasPropertyList,
                             rapidjson::Value &shapesArray,
                             rapidjson::Value &headObject)
   {
@@ -542,14 +822,28 @@ namespace lc2kicad
 
     assertThrow(parseTarget.HasMember("canvas"), "\"canvas\" not found.");
     assertThrow(parseTarget["canvas"].IsString(), "Invalid \"canvas\" type: not string.");
-    string canvasPropertyString = parseTarget["canvas"].GetString();
-    canvasPropertyList = splitString(canvasPropertyString, '~');
+    canvasPropertyList = fieldList(fieldView(parseTarget["canvas"].GetString(), parseTarget["canvas"].GetStringLength()), '~');
 
     assertThrow(parseTarget.HasMember("shape"), "\"shape\" not found.");
     assertThrow(parseTarget["shape"].IsArray(), "Invalid \"shape\" type: not array.");
     shapesArray = parseTarget["shape"].GetArray();
   }
 
+  void LCJSONSerializer::attachShapeStream(EasyEDAStreamReader *stream) { shapeStream = stream; }
+
+  /**
+   * Hand every shape of the working document to the consumer, in order. Shapes come from the "shape"
+   * array, or straight from the input file when a shape stream is attached (streaming parse mode).
+   */
+  void LCJSONSerializer::forEachShape(rapidjson::Value &shapesArray, const std::function<void(const fieldView&)> &consumer)
+  {
+    if(shapeStream)
+      shapeStream->readShapes(consumer);
+    else
+      for(unsigned int i = 0; i < shapesArray.Size(); i++)
+        consumer(fieldView(shapesArray[i].GetString(), shapesArray[i].GetStringLength()));
+  }
+
   void LCJSONSerializer::parsePCBDRCRules(rapidjson::Value &drcRules)
   {
     ASSERT_RETURN_MSG(drcRules.IsObject(), "Invalid DRC entry.");
@@ -600,13 +894,12 @@ namespace lc2kicad
    * The below section is for PCB elements serializing.
    */
 
-  PCB_Pad* LCJSONSerializer::parsePCBPadString(const string &LCJSONString)
+  PCB_Pad* LCJSONSerializer::parsePCBPadString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_Pad> result;
-    stringlist paramList = splitString(LCJSONString, '~');
-    stringlist polygonDrillCoordsString;
+    PCB_Pad *result = createElement<PCB_Pad>(context.owner->elementArena);
+    fieldList polygonDrillCoordsString;
 
-    result->id = paramList[12]; // GGE ID.
+    result->id = paramList[12].str(); // GGE ID.
 
     // Resolve pad shape
     switch (paramList[1][0])
@@ -624,53 +917,54 @@ namespace lc2kicad
         result->padShape = PCBPadShape::polygon;
         break;
       default:
-        assertThrow(false, result->id + string(": Invalid pad shape: ") + paramList[12]);
+        assertThrow(false, result->id + ": Invalid pad shape: " + paramList[12]);
         break;
     }
 
     // Resolve pad coordinates
     if(result->padShape == PCBPadShape::polygon)
     {
-      polygonDrillCoordsString = splitString(paramList[19], ',');
-      result->padCoordinates.X = (stod(polygonDrillCoordsString[0]) - workingDocument->origin.X) * tenmils_to_mm_coefficient;
-      result->padCoordinates.Y = (stod(polygonDrillCoordsString[1]) - workingDocument->origin.Y) * tenmils_to_mm_coefficient;
+      polygonDrillCoordsString = fieldList(paramList[19], ',');
+      result->padCoordinates.X = (tolStod(polygonDrillCoordsString[0]) - context.origin.X) * tenmils_to_mm_coefficient;
+      result->padCoordinates.Y = (tolStod(polygonDrillCoordsString[1]) - context.origin.Y) * tenmils_to_mm_coefficient;
       result->orientation = 0;
     }
     else
     {
-      result->padCoordinates.X = (stod(paramList[2]) - workingDocument->origin.X) * tenmils_to_mm_coefficient;
-      result->padCoordinates.Y = (stod(paramList[3]) - workingDocument->origin.Y) * tenmils_to_mm_coefficient;
-      result->orientation = (stod(paramList[11]));
+      result->padCoordinates.X = (tolStod(paramList[2]) - context.origin.X) * tenmils_to_mm_coefficient;
+      result->padCoordinates.Y = (tolStod(paramList[3]) - context.origin.Y) * tenmils_to_mm_coefficient;
+      result->orientation = (tolStod(paramList[11]));
     }
 
     // Resolve pad shape and size
     if(result->padShape == PCBPadShape::oval || result->padShape == PCBPadShape::rectangle)
     {
-      result->padSize.X = stod(paramList[4]) * tenmils_to_mm_coefficient;
-      result->padSize.Y = stod(paramList[5]) * tenmils_to_mm_coefficient;
+      result->padSize.X = tolStod(paramList[4]) * tenmils_to_mm_coefficient;
+      result->padSize.Y = tolStod(paramList[5]) * tenmils_to_mm_coefficient;
     }
     else if(result->padShape == PCBPadShape::circle)
-      result->padSize.X = result->padSize.Y = stod(paramList[4]) * tenmils_to_mm_coefficient;
+      result->padSize.X = result->padSize.Y = tolStod(paramList[4]) * tenmils_to_mm_coefficient;
     else // polygon
     {
       result->padSize.X = result->padSize.Y = result->holeSize.Y;
-      vector<string> polygonCoordinates = splitString(paramList[10], ' ');
+      fieldTokenizer polygonCoordinates(paramList[10], ' ');
+      fieldView coordX, coordY;
       coordinates polygonPointTemp = { 0.0, 0.0 };
       /**
        * EasyEDA rotate their polygon pads at the "pad center" where the drill has its own coordinates,
        * while KiCad rotate the polygon pads at the drill center since the drill is the pad origin.
        * Here we need to manipulate the pad a little bit so it would not cause problems.
        */
-      for(unsigned int i = 0; i < polygonCoordinates.size(); i += 2)
+      while(polygonCoordinates.next(coordX) && polygonCoordinates.next(coordY))
       {
-        polygonPointTemp.X = (stod(polygonCoordinates[  i  ]) - stod(polygonDrillCoordsString[0])) * tenmils_to_mm_coefficient;
-        polygonPointTemp.Y = (stod(polygonCoordinates[i + 1]) - stod(polygonDrillCoordsString[1])) * tenmils_to_mm_coefficient;
+        polygonPointTemp.X = (tolStod(coordX) - tolStod(polygonDrillCoordsString[0])) * tenmils_to_mm_coefficient;
+        polygonPointTemp.Y = (tolStod(coordY) - tolStod(polygonDrillCoordsString[1])) * tenmils_to_mm_coefficient;
         result->shapePolygonPoints.push_back(polygonPointTemp);
       }
     }
 
     // Resolve pad type
-    int padTypeTemp = stoi(paramList[6]);
+    int padTypeTemp = tolStoi(paramList[6]);
     if(padTypeTemp == 11)
       if(paramList[15] == "Y")
         result->padType = PCBPadType::through;
@@ -684,8 +978,8 @@ namespace lc2kicad
     if(padTypeTemp == 11) // Fix: Only parse hole size when the pad is a through-hole pad.
     {
       // Resolve hole shape size
-      result->holeSize.X = stod(paramList[13]) * tenmils_to_mm_coefficient;
-      result->holeSize.Y = (stod(paramList[9]) * 2 * tenmils_to_mm_coefficient);
+      result->holeSize.X = tolStod(paramList[13]) * tenmils_to_mm_coefficient;
+      result->holeSize.Y = (tolStod(paramList[9]) * 2 * tenmils_to_mm_coefficient);
       result->holeSize.X == 0.0f ? result->holeSize.X = result->holeSize.Y, result->holeShape = PCBHoleShape::circle : result->holeShape = PCBHoleShape::slot;
       /**
        * Fix: EasyEDA determines the slot direction by pad size.
@@ -697,18 +991,17 @@ namespace lc2kicad
         result->holeSize.swapXY();
     }
     // store net name
-    static_cast<PCBDocument*>(workingDocument)->netManager.setNet(paramList[7], result->net);
-    result->pinNumber = paramList[8];
+    context.owner->netManager.setNet(paramList[7].str(), result->net);
+    result->pinNumber = context.owner->stringPool.intern(paramList[8]);
 
-    //workingDocument->containedElements.push_back(!++result);
-    return !++result;
+    return result;
   }
 
-  PCB_Module *LCJSONSerializer::parsePCBDiscretePadString(const string &LCJSONString)
+  PCB_Module *LCJSONSerializer::parsePCBDiscretePadString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_Module> result;
-    RAIIC<PCB_Pad> pad = parsePCBPadString(LCJSONString);
-    RAIIC<PCB_Text> ref;
+    PCB_Module *result = createElement<PCB_Module>(context.owner->elementArena);
+    PCB_Pad *pad = parsePCBPadString(context, paramList);
+    PCB_Text *ref = createElement<PCB_Text>(context.owner->elementArena);
 
     result->id = pad->id;
     result->name = "DiscretePad" + pad->id;
@@ -738,142 +1031,132 @@ namespace lc2kicad
         break;
     }
 
-    result->containedElements.push_back(!++pad);
-    result->containedElements.push_back(!++ref);
+    result->containedElements.push_back(pad);
+    result->containedElements.push_back(ref);
 
     result->updateTime = time(nullptr);
 
-    return !++result;
+    return result;
   }
 
-  PCB_Hole* LCJSONSerializer::parsePCBHoleString(const string &LCJSONString)
+  PCB_Hole* LCJSONSerializer::parsePCBHoleString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_Hole> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_Hole *result = createElement<PCB_Hole>(context.owner->elementArena);
 
-    result->id = paramList[4]; // GGE ID.
+    result->id = paramList[4].str(); // GGE ID.
 
-    result->holeCoordinates.X = (stod(paramList[1]) - workingDocument->origin.X) * tenmils_to_mm_coefficient;
-    result->holeCoordinates.Y = (stod(paramList[2]) - workingDocument->origin.Y) * tenmils_to_mm_coefficient;
-    result->holeDiameter = stod(paramList[3]) * 2 * tenmils_to_mm_coefficient;
+    result->holeCoordinates.X = (tolStod(paramList[1]) - context.origin.X) * tenmils_to_mm_coefficient;
+    result->holeCoordinates.Y = (tolStod(paramList[2]) - context.origin.Y) * tenmils_to_mm_coefficient;
+    result->holeDiameter = tolStod(paramList[3]) * 2 * tenmils_to_mm_coefficient;
 
-    return !++result;
+    return result;
   }
 
-  PCB_Via* LCJSONSerializer::parsePCBViaString(const string &LCJSONString)
+  PCB_Via* LCJSONSerializer::parsePCBViaString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_Via> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_Via *result = createElement<PCB_Via>(context.owner->elementArena);
 
-    result->id = paramList[6]; // GGE ID.
+    result->id = paramList[6].str(); // GGE ID.
 
     // Resolving the via coordinates
-    result->holeCoordinates.X = (stod(paramList[1]) - workingDocument->origin.X) * tenmils_to_mm_coefficient;
-    result->holeCoordinates.Y = (stod(paramList[2]) - workingDocument->origin.Y) * tenmils_to_mm_coefficient;
+    result->holeCoordinates.X = (tolStod(paramList[1]) - context.origin.X) * tenmils_to_mm_coefficient;
+    result->holeCoordinates.Y = (tolStod(paramList[2]) - context.origin.Y) * tenmils_to_mm_coefficient;
     // Resolve via diameter (size)
-    result->viaDiameter = stod(paramList[3]) * tenmils_to_mm_coefficient;
-    result->holeDiameter = stod(paramList[5]) * tenmils_to_mm_coefficient * 2; // Hole "holeR" is radius.
+    result->viaDiameter = tolStod(paramList[3]) * tenmils_to_mm_coefficient;
+    result->holeDiameter = tolStod(paramList[5]) * tenmils_to_mm_coefficient * 2; // Hole "holeR" is radius.
 
-    static_cast<PCBDocument*>(workingDocument)->netManager.setNet(paramList[4], result->net);
+    context.owner->netManager.setNet(paramList[4].str(), result->net);
 
-    return !++result;
+    return result;
   }
 
-  PCB_CopperTrack* LCJSONSerializer::parsePCBCopperTrackString(const string &LCJSONString)
+  PCB_CopperTrack* LCJSONSerializer::parsePCBCopperTrackString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_CopperTrack> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_CopperTrack *result = createElement<PCB_CopperTrack>(context.owner->elementArena);
 
-    result->id = paramList[5];
+    result->id = paramList[5].str();
 
     // Resolve track width
-    result->width = stod(paramList[1]) * tenmils_to_mm_coefficient;
+    result->width = tolStod(paramList[1]) * tenmils_to_mm_coefficient;
 
     // Resolve track layer
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[2])];
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[2])];
     assertThrow(result->layerKiCad != KiCadLayerIndex::Invalid, result->id + (": Invalid layer for TRACK " + paramList[3]));
-    static_cast<PCBDocument*>(workingDocument)->netManager.setNet(paramList[3], result->net);
-
-    // Resolve track points
-    stringlist pointsStrList = splitString(paramList[4], ' ');
-    coordinates tempCoord;
-    for(unsigned int i = 0; i < pointsStrList.size(); i += 2)
-    {
-      tempCoord.X = (stod(pointsStrList[i]) - workingDocument->origin.X) * tenmils_to_mm_coefficient;
-      tempCoord.Y = (stod(pointsStrList[i + 1]) - workingDocument->origin.Y) * tenmils_to_mm_coefficient;
-      result->trackPoints.push_back(tempCoord);
-    }
-
-    return !++result;
+    context.owner->netManager.setNet(paramList[3].str(), result->net);
+
+    // Resolve track points. They're moved to the document origin and scaled after the whole document is read.
+    fieldTokenizer pointsStrList(paramList[4], ' ');
+    fieldView pointX, pointY;
+    PointPool &points = context.owner->pointPool;
+    size_t firstPoint = points.beginRange(context.origin, tenmils_to_mm_coefficient);
+    while(pointsStrList.next(pointX) && pointsStrList.next(pointY))
+      points.append(tolStod(pointX), tolStod(pointY));
+    result->trackPoints = points.endRange(firstPoint);
+
+    return result;
   }
 
-  PCB_GraphicalTrack* LCJSONSerializer::parsePCBGraphicalTrackString(const string &LCJSONString)
+  PCB_GraphicalTrack* LCJSONSerializer::parsePCBGraphicalTrackString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_GraphicalTrack> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_GraphicalTrack *result = createElement<PCB_GraphicalTrack>(context.owner->elementArena);
 
-    result->id = paramList[5]; // GGE ID.
+    result->id = paramList[5].str(); // GGE ID.
 
     // Resolve track width
-    result->width = stod(paramList[1]) * tenmils_to_mm_coefficient;
+    result->width = tolStod(paramList[1]) * tenmils_to_mm_coefficient;
 
     // Resolve track layer
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[2])];
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[2])];
     if(result->layerKiCad == KiCadLayerIndex::Invalid)
     {
       VERBOSE_INFO(result->id + ": Invalid layer " + paramList[2] + " for graphical TRACK");
       return nullptr;
     }
 
-    // Resolve track points
-    stringlist pointsStrList = splitString(paramList[4], ' ');
-    coordinates tempCoord;
-    for(unsigned int i = 0; i < pointsStrList.size(); i += 2)
-    {
-      tempCoord.X = (stod(pointsStrList[i]) - workingDocument->origin.X) * tenmils_to_mm_coefficient;
-      tempCoord.Y = (stod(pointsStrList[i + 1]) - workingDocument->origin.Y) * tenmils_to_mm_coefficient;
-      result->trackPoints.push_back(tempCoord);
-    }
+    // Resolve track points. They're moved to the document origin and scaled after the whole document is read.
+    fieldTokenizer pointsStrList(paramList[4], ' ');
+    fieldView pointX, pointY;
+    PointPool &points = context.owner->pointPool;
+    size_t firstPoint = points.beginRange(context.origin, tenmils_to_mm_coefficient);
+    while(pointsStrList.next(pointX) && pointsStrList.next(pointY))
+      points.append(tolStod(pointX), tolStod(pointY));
+    result->trackPoints = points.endRange(firstPoint);
 
-    return !++result;
+    return result;
   }
 
-  PCB_FloodFill* LCJSONSerializer::parsePCBFloodFillString(const string &LCJSONString)
+  PCB_FloodFill* LCJSONSerializer::parsePCBFloodFillString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_FloodFill> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_FloodFill *result = createElement<PCB_FloodFill>(context.owner->elementArena);
 
-    result->id = paramList[7]; // GGE ID.
+    result->id = paramList[7].str(); // GGE ID.
 
     // Resolve layer ID and net name
-    static_cast<PCBDocument*>(workingDocument)->netManager.setNet(paramList[3], result->net);
+    context.owner->netManager.setNet(paramList[3].str(), result->net);
 
     // Old EasyEDA file omits the priority. Send a warning and set that to highest if this happened.
     if(!paramList[13].size())
-    {
       Warn(result->id + ": Empty flood fill priority. Will be set to highest.");
-      paramList[13] = "1";
-    }
-    static_cast<PCBDocument*>(workingDocument)->fillPriorityManager.logPriority(result->EasyEDAPriority = stoi(paramList[13]));
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[2])];
+    context.owner->fillPriorityManager.logPriority(result->EasyEDAPriority = tolStoi(paramList[13], 1));
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[2])];
     // Throw error with gge ID if layer is invalid
     assertThrow(result->layerKiCad != -1, result->id + ": Invalid layer for COPPERAREA " + paramList[7]);
 
     // Resolve track points
-    auto path = SmolSVG::readPathString(paramList[4]);
+    const SmolSVG::pathBuffer &path = readSVGPath(paramList[4], result->id);
 
-    for(auto &i : *path)
-      result->fillAreaPolygonPoints.emplace_back(
-              (i->getConstStartPoint().nativeCoord() - workingDocument->origin) * tenmils_to_mm_coefficient);
-    delete path;
+    PointPool &points = context.owner->pointPool;
+    size_t firstPoint = points.beginRange(context.origin, tenmils_to_mm_coefficient);
+    flattenPath(path, points, curveTolerance);
+    result->fillAreaPolygonPoints = endPolygonRange(context, firstPoint);
 
-    result->clearanceWidth = stod(paramList[5]) * tenmils_to_mm_coefficient; // Resolve clearance width
+    result->clearanceWidth = tolStod(paramList[5]) * tenmils_to_mm_coefficient; // Resolve clearance width
     result->fillStyle = (paramList[6] == "solid" ? floodFillStyle::solidFill : floodFillStyle::noFill);
     // Resolve fill style
     result->isSpokeConnection = (paramList[8] == "spoke" ? true : false); // Resolve connection type
     result->isPreservingIslands = (paramList[9] == "yes" ? true : false); // Resolve island keep
     result->minimumWidth = 0.254; // 20 mils; KiCad default.
-    result->spokeWidth = stod(paramList[18]) * tenmils_to_mm_coefficient;
+    result->spokeWidth = tolStod(paramList[18]) * tenmils_to_mm_coefficient;
     if(result->spokeWidth <= 0)
     {
       result->spokeWidth = 0.508;
@@ -886,62 +1169,58 @@ namespace lc2kicad
                                                       "Minimum width was set to the spoke width automatically from 0.254mm.");
     }
 
-    return !++result;
+    return result;
   }
 
-  PCB_KeepoutRegion *LCJSONSerializer::parsePCBKeepoutRegionString(const string &LCJSONString)
+  PCB_KeepoutRegion *LCJSONSerializer::parsePCBKeepoutRegionString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_KeepoutRegion> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_KeepoutRegion *result = createElement<PCB_KeepoutRegion>(context.owner->elementArena);
 
-    result->id = paramList[5];
+    result->id = paramList[5].str();
 
     result->allowRouting = result->allowVias = true;
     result->allowFloodFill = false;
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[1])];
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[1])];
 
-    auto path = SmolSVG::readPathString(paramList[3]);
-    for(auto &i : *path)
-      result->fillAreaPolygonPoints.emplace_back(
-              (i->getConstStartPoint().nativeCoord() - workingDocument->origin) * tenmils_to_mm_coefficient);
-    delete path;
+    const SmolSVG::pathBuffer &path = readSVGPath(paramList[3], result->id);
+    PointPool &points = context.owner->pointPool;
+    size_t firstPoint = points.beginRange(context.origin, tenmils_to_mm_coefficient);
+    flattenPath(path, points, curveTolerance);
+    result->fillAreaPolygonPoints = points.endRange(firstPoint);
 
     Warn(result->id + ": Flood fill keepout regions will prevent all fills rather than just flood fills with "
                       "lower priority. This is a behavior difference. You've been warned.");
-    return !++result;
+    return result;
   }
 
-  PCB_GraphicalTrack *LCJSONSerializer::parsePCBNpthRegionString(const string &LCJSONString)
+  PCB_GraphicalTrack *LCJSONSerializer::parsePCBNpthRegionString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_GraphicalTrack> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_GraphicalTrack *result = createElement<PCB_GraphicalTrack>(context.owner->elementArena);
 
-    result->id = paramList[5];
+    result->id = paramList[5].str();
     result->layerKiCad = Edge_Cuts;
 
     // Resolve track points
-    auto path = SmolSVG::readPathString(paramList[3]);
-
-    for(auto &i : *path)
-      result->trackPoints.emplace_back(
-              (i->getConstStartPoint().nativeCoord() - workingDocument->origin) * tenmils_to_mm_coefficient);
-    result->trackPoints.emplace_back(
-            (path->getLastCommand()->getConstEndPoint().nativeCoord() - workingDocument->origin) * tenmils_to_mm_coefficient);
-    delete path;
+    const SmolSVG::pathBuffer &path = readSVGPath(paramList[3], result->id);
+    PointPool &points = context.owner->pointPool;
+    size_t firstPoint = points.beginRange(context.origin, tenmils_to_mm_coefficient);
+    flattenPath(path, points, curveTolerance);
+    if(!path.empty())
+      points.append(path.endPoint(path.back()).nativeCoord());
+    result->trackPoints = points.endRange(firstPoint);
 
     result->width = 0.1;
 
-    return !++result;
+    return result;
   }
 
-  PCB_GraphicalSolidRegion *LCJSONSerializer::parsePCBGraphicalSolidRegionString(const std::string &LCJSONString)
+  PCB_GraphicalSolidRegion *LCJSONSerializer::parsePCBGraphicalSolidRegionString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_GraphicalSolidRegion> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_GraphicalSolidRegion *result = createElement<PCB_GraphicalSolidRegion>(context.owner->elementArena);
 
-    result->id = paramList[5];
+    result->id = paramList[5].str();
 
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[1])];
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[1])];
 
     // Fail gracefully if you got an area on an invalid layer
     if(result->layerKiCad == Invalid)
@@ -951,112 +1230,105 @@ namespace lc2kicad
     }
 
     // Resolve track points
-    auto path = SmolSVG::readPathString(paramList[3]);
-
-    for(auto &i : *path)
-      result->fillAreaPolygonPoints.emplace_back(
-              (i->getConstStartPoint().nativeCoord() - workingDocument->origin) * tenmils_to_mm_coefficient);
-    delete path;
+    const SmolSVG::pathBuffer &path = readSVGPath(paramList[3], result->id);
+    PointPool &points = context.owner->pointPool;
+    size_t firstPoint = points.beginRange(context.origin, tenmils_to_mm_coefficient);
+    flattenPath(path, points, curveTolerance);
+    result->fillAreaPolygonPoints = endPolygonRange(context, firstPoint);
 
-    return !++result;
-
-    return !++result;
+    return result;
   }
 
-  PCB_FloodFill* LCJSONSerializer::parsePCBCopperSolidRegionString(const string &LCJSONString)
+  PCB_FloodFill* LCJSONSerializer::parsePCBCopperSolidRegionString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_FloodFill> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_FloodFill *result = createElement<PCB_FloodFill>(context.owner->elementArena);
 
-    result->id = paramList[5];
+    result->id = paramList[5].str();
     // Resolve layer ID and net name
-    static_cast<PCBDocument*>(workingDocument)->netManager.setNet(paramList[2], result->net);
+    context.owner->netManager.setNet(paramList[2].str(), result->net);
     result->EasyEDAPriority = 0;
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[1])];
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[1])];
     // Throw error with gge ID if layer is invalid
     assertThrow(result->layerKiCad != -1, result->id + ": Invalid layer for copper SOLIDREGION");
 
     // Resolve track points
-    auto path = SmolSVG::readPathString(paramList[3]);
-
-    for(auto &i : *path)
-      result->fillAreaPolygonPoints.emplace_back(
-                  (i->getConstStartPoint().nativeCoord() - workingDocument->origin) * tenmils_to_mm_coefficient);
-    delete path;
+    const SmolSVG::pathBuffer &path = readSVGPath(paramList[3], result->id);
+    PointPool &points = context.owner->pointPool;
+    size_t firstPoint = points.beginRange(context.origin, tenmils_to_mm_coefficient);
+    flattenPath(path, points, curveTolerance);
+    result->fillAreaPolygonPoints = endPolygonRange(context, firstPoint);
 
-    return !++result;
+    return result;
   }
 
-  PCB_FloodFill *LCJSONSerializer::parsePCBPlaneZoneString(const string &LCJSONString)
+  PCB_FloodFill *LCJSONSerializer::parsePCBPlaneZoneString(const pcbShapeContext &context, const fieldView &LCJSONString) const
   {
-    RAIIC<PCB_FloodFill> result;
-    stringlist parts = splitByString(LCJSONString, "#@$");
+    PCB_FloodFill *result = createElement<PCB_FloodFill>(context.owner->elementArena);
+    vector<fieldView> parts;
+    splitByString(LCJSONString, "#@$", parts);
 
     ASSERT_RETNULLPTR_MSG(parts.size() == 2, "Invalid PLANEZONE <<<" + LCJSONString + ">>>.");
 
-    stringlist paramList = splitString(parts[0], '~'),
-               pathList = splitString(parts[1], '~');
+    fieldList paramList(parts[0], '~'),
+              pathList(parts[1], '~');
 
-    result->id = paramList[4]; // We use the GGE ID of zone instead of the path.
+    result->id = paramList[4].str(); // We use the GGE ID of zone instead of the path.
 
     Info(result->id + ": Plane zone has been converted to a flood fill zone. "
                         "You'll need to delete the tracks used to separate the zones.");
 
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[1])];
-    static_cast<PCBDocument*>(workingDocument)->netManager.setNet(paramList[2], result->net);
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[1])];
+    context.owner->netManager.setNet(paramList[2].str(), result->net);
 
-    pathList[1].pop_back(); // Remove trailing Z
-    pathList[1][0] = '0'; // Remove leading M
-    stringlist pointsList = splitString(pathList[1], ' '); // Split point data
+    fieldTokenizer pointsList(pathList[1].substr(1, pathList[1].size() - 2), ' '); // Remove leading M and trailing Z
+    fieldView point;
+    PointPool &points = context.owner->pointPool;
+    size_t firstPoint = points.beginRange(context.origin, tenmils_to_mm_coefficient);
 
-    for(auto &i : pointsList)
+    while(pointsList.next(point))
     {
-      stringlist pointCoord = splitString(i, ',');
-      result->fillAreaPolygonPoints.emplace_back(
-            (coordinates(stoi(pointCoord[0]), stoi(pointCoord[1])) - workingDocument->origin)
-            * tenmils_to_mm_coefficient
-          );
+      fieldList pointCoord(point, ',');
+      points.append(tolStoi(pointCoord[0]), tolStoi(pointCoord[1]));
     }
+    result->fillAreaPolygonPoints = endPolygonRange(context, firstPoint);
 
-    return !++result;
+    return result;
   }
 
-  PCB_CopperCircle* LCJSONSerializer::parsePCBCopperCircleString(const string &LCJSONString)
+  PCB_CopperCircle* LCJSONSerializer::parsePCBCopperCircleString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_CopperCircle> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_CopperCircle *result = createElement<PCB_CopperCircle>(context.owner->elementArena);
 
-    result->id = paramList[6]; // GGE ID.
+    result->id = paramList[6].str(); // GGE ID.
 
-    result->center.X = stod(paramList[1]) * tenmils_to_mm_coefficient;
-    result->center.Y = stod(paramList[2]) * tenmils_to_mm_coefficient;
-    result->radius = stod(paramList[3]) * tenmils_to_mm_coefficient;
-    result->width = stod(paramList[4]) * tenmils_to_mm_coefficient;
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[5])];
-    static_cast<PCBDocument*>(workingDocument)->netManager.setNet(paramList[8], result->net);
+    result->center.X = tolStod(paramList[1]) * tenmils_to_mm_coefficient;
+    result->center.Y = tolStod(paramList[2]) * tenmils_to_mm_coefficient;
+    result->radius = tolStod(paramList[3]) * tenmils_to_mm_coefficient;
+    result->width = tolStod(paramList[4]) * tenmils_to_mm_coefficient;
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[5])];
+    context.owner->netManager.setNet(paramList[8].str(), result->net);
 
-    return !++result;
+    return result;
   }
 
-  PCB_GraphicalCircle* LCJSONSerializer::parsePCBGraphicalCircleString(const string &LCJSONString)
+  PCB_GraphicalCircle* LCJSONSerializer::parsePCBGraphicalCircleString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_GraphicalCircle> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_GraphicalCircle *result = createElement<PCB_GraphicalCircle>(context.owner->elementArena);
 
-    result->id = paramList[6]; // GGE ID.
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[5])];
+    result->id = paramList[6].str(); // GGE ID.
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[5])];
     if(result->layerKiCad == Invalid)
     {
       VERBOSE_INFO(result->id + ": Invalid layer " + paramList[5] + " for graphical ARC");
       return nullptr;
     }
 
-    result->center.X = (stod(paramList[1]) - workingDocument->origin.X) * tenmils_to_mm_coefficient;
-    result->center.Y = (stod(paramList[2]) - workingDocument->origin.Y) * tenmils_to_mm_coefficient;
-    result->radius = stod(paramList[3]) * tenmils_to_mm_coefficient;
-    result->width = stod(paramList[4]) * tenmils_to_mm_coefficient;
+    result->center.X = (tolStod(paramList[1]) - context.origin.X) * tenmils_to_mm_coefficient;
+    result->center.Y = (tolStod(paramList[2]) - context.origin.Y) * tenmils_to_mm_coefficient;
+    result->radius = tolStod(paramList[3]) * tenmils_to_mm_coefficient;
+    result->width = tolStod(paramList[4]) * tenmils_to_mm_coefficient;
 
-    return !++result;
+    return result;
   }
 
   /*
@@ -1064,94 +1336,68 @@ namespace lc2kicad
     Original: https://github.com/wokwi/easyeda2kicad/blob/master/src/board.ts
   */
 
-  PCB_CopperArc *LCJSONSerializer::parsePCBCopperArcString(const string &LCJSONString)
+  PCB_CopperArc *LCJSONSerializer::parsePCBCopperArcString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_CopperArc> result;
-    stringlist paramList = splitString(LCJSONString, '~'), arcCmdParams, movetoCmdParams;
+    PCB_CopperArc *result = createElement<PCB_CopperArc>(context.owner->elementArena);
 
-    result->id = paramList[6]; // GGE ID
+    result->id = paramList[6].str(); // GGE ID
 
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[2])];
-    result->width = stod(paramList[1]) * tenmils_to_mm_coefficient;
-    static_cast<PCBDocument*>(workingDocument)->netManager.setNet(paramList[3], result->net);
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[2])];
+    result->width = tolStod(paramList[1]) * tenmils_to_mm_coefficient;
+    context.owner->netManager.setNet(paramList[3].str(), result->net);
 
-    // Resolve track points
-    auto path = SmolSVG::readPathString(paramList[4]);
-    coordinates startpoint = path->getLastCommand()->getConstStartPoint(),
-            endpoint = path->getLastCommand()->getConstEndPoint();
-    auto &smolArcCmd = *(static_cast<SmolSVG::commandEllipticalArcTo*>(path->getLastCommand()));
+    // Center, angle and end point are resolved along with the other arcs of the document
+    queuePCBArc(context, paramList[4], result);
 
-    centerArc resultArc = svgEllipticalArcComputation(startpoint.X, startpoint.Y, smolArcCmd.getRadii().X,
-                                                      smolArcCmd.getRadii().Y, smolArcCmd.getXAxisRotation(), smolArcCmd.getLargeArc(),
-                                                      smolArcCmd.getFlagSweep(), endpoint.X, endpoint.Y);
-
-    result->center = (resultArc.center - workingDocument->origin) * tenmils_to_mm_coefficient;
-    result->angle = std::abs(resultArc.angleExtend);
-    result->endPoint = ((smolArcCmd.getFlagSweep() ? startpoint : endpoint) - workingDocument->origin) * tenmils_to_mm_coefficient;
-
-    return !++result;
+    return result;
 
   }
 
-  PCB_GraphicalArc *LCJSONSerializer::parsePCBGraphicalArcString(const string &LCJSONString)
+  PCB_GraphicalArc *LCJSONSerializer::parsePCBGraphicalArcString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_GraphicalArc> result;
-    stringlist paramList = splitString(LCJSONString, '~'), arcCmdParams, movetoCmdParams;
+    PCB_GraphicalArc *result = createElement<PCB_GraphicalArc>(context.owner->elementArena);
 
-    result->id = paramList[6]; // GGE ID
+    result->id = paramList[6].str(); // GGE ID
 
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[2])];
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[2])];
     if(result->layerKiCad == Invalid)
     {
       VERBOSE_INFO(result->id + ": Invalid layer " + paramList[2] + " for ARC");
       return nullptr;
     }
 
-    result->width = stod(paramList[1]) * tenmils_to_mm_coefficient;
-
-    // Resolve track points
-    auto path = SmolSVG::readPathString(paramList[4]);
-    coordinates startpoint = path->getLastCommand()->getConstStartPoint(),
-                endpoint = path->getLastCommand()->getConstEndPoint();
-    auto &smolArcCmd = *(static_cast<SmolSVG::commandEllipticalArcTo*>(path->getLastCommand()));
+    result->width = tolStod(paramList[1]) * tenmils_to_mm_coefficient;
 
-    centerArc resultArc = svgEllipticalArcComputation(startpoint.X, startpoint.Y, smolArcCmd.getRadii().X,
-                            smolArcCmd.getRadii().Y, smolArcCmd.getXAxisRotation(), smolArcCmd.getLargeArc(),
-                            smolArcCmd.getFlagSweep(), endpoint.X, endpoint.Y);
+    // Center, angle and end point are resolved along with the other arcs of the document
+    queuePCBArc(context, paramList[4], result);
 
-    result->center = (resultArc.center - workingDocument->origin) * tenmils_to_mm_coefficient;
-    result->angle = std::abs(resultArc.angleExtend);
-    result->endPoint = ((smolArcCmd.getFlagSweep() ? startpoint : endpoint) - workingDocument->origin) * tenmils_to_mm_coefficient;
-
-    return !++result;
+    return result;
   }
 
-  PCB_Rect* LCJSONSerializer::parsePCBRectString(const string &LCJSONString)
+  PCB_Rect* LCJSONSerializer::parsePCBRectString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_Rect> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_Rect *result = createElement<PCB_Rect>(context.owner->elementArena);
 
-    result->id = paramList[6]; // GGE ID.
+    result->id = paramList[6].str(); // GGE ID.
 
-    result->topLeftPos.X = (stod(paramList[1]) - workingDocument->origin.X) * tenmils_to_mm_coefficient;
-    result->topLeftPos.Y = (stof(paramList[2]) - workingDocument->origin.Y) * tenmils_to_mm_coefficient;
-    result->size.X = stod(paramList[3]) * tenmils_to_mm_coefficient;
-    result->size.Y = stod(paramList[4]) * tenmils_to_mm_coefficient;
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[5])];
-    result->strokeWidth = stod(paramList[8]) * tenmils_to_mm_coefficient;
+    result->topLeftPos.X = (tolStod(paramList[1]) - context.origin.X) * tenmils_to_mm_coefficient;
+    result->topLeftPos.Y = (tolStod(paramList[2]) - context.origin.Y) * tenmils_to_mm_coefficient;
+    result->size.X = tolStod(paramList[3]) * tenmils_to_mm_coefficient;
+    result->size.Y = tolStod(paramList[4]) * tenmils_to_mm_coefficient;
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[5])];
+    result->strokeWidth = tolStod(paramList[8]) * tenmils_to_mm_coefficient;
 
-    return !++result;
+    return result;
   }
 
-  PCB_Text *LCJSONSerializer::parsePCBTextString(const string &LCJSONString)
+  PCB_Text *LCJSONSerializer::parsePCBTextString(const pcbShapeContext &context, const fieldList &paramList) const
   {
-    RAIIC<PCB_Text> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    PCB_Text *result = createElement<PCB_Text>(context.owner->elementArena);
 
-    result->id = paramList[13];
+    result->id = paramList[13].str();
 
     // Know what type this text is.
-    result->text = escapeQuotedString(paramList[10]);
+    result->text = escapeQuotedString(paramList[10].str());
     if(paramList[1].length() == 1)
       switch(paramList[1][0])
       {
@@ -1170,18 +1416,18 @@ namespace lc2kicad
     if(exportNestedLibs && result->type != PCBTextTypes::StandardText)
       return nullptr;
 
-    result->height = stod(paramList[9]) * tenmils_to_mm_coefficient;
-    result->orientation = stod(paramList[5]);
-    result->midLeftPos = (coordinates(stod(paramList[2]) - (result->height - 2) * cos(toRadians(result->orientation + 90)),
-                    stod(paramList[3]) - (result->height + 2) * sin(toRadians(result->orientation + 90)))
-              - workingDocument->origin) * tenmils_to_mm_coefficient;
+    result->height = tolStod(paramList[9]) * tenmils_to_mm_coefficient;
+    result->orientation = tolStod(paramList[5]);
+    result->midLeftPos = (coordinates(tolStod(paramList[2]) - (result->height - 2) * cos(toRadians(result->orientation + 90)),
+                    tolStod(paramList[3]) - (result->height + 2) * sin(toRadians(result->orientation + 90)))
+              - context.origin) * tenmils_to_mm_coefficient;
 
     // Crude fix for shift down issue
     //result->midLeftPos.Y -= 0.5;
 
-    result->width = stod(paramList[4]) * tenmils_to_mm_coefficient;
+    result->width = tolStod(paramList[4]) * tenmils_to_mm_coefficient;
     result->mirrored = tolStoi(paramList[6]);
-    result->layerKiCad = EasyEdaToKiCadLayerMap[stoi(paramList[7])];
+    result->layerKiCad = EasyEdaToKiCadLayerMap[tolStoi(paramList[7])];
 
     if(paramList[14] != "")
     {
@@ -1194,91 +1440,95 @@ namespace lc2kicad
     else
       result->visibility = true;
 
-    return !++result;
+    return result;
   }
 
-  PCB_Module* LCJSONSerializer::parsePCBModuleString(const string &LCJSONString, EDADocument *parent,
-                           map<string, RAIIC<EDADocument>> *exportedList)
+  PCB_Module* LCJSONSerializer::parsePCBModuleString(const pcbShapeContext &context, const fieldView &LCJSONString,
+                                                     nestedLibraryCache *exportedList) const
   {
-    RAIIC<PCB_Module> result;
-    stringlist shapesList = splitByString(LCJSONString, string("#@$")),
-        moduleHeader = splitString(shapesList[0], '~'),
-        cparaTmp = splitString(moduleHeader[3], '`');
+    pcbShapeContext moduleContext;
+    fieldView shapesString;
+    PCB_Module *result = parsePCBModuleHeader(context, LCJSONString, exportedList, moduleContext, shapesString);
+    if(result)
+      parsePCBModuleShapes(moduleContext, shapesString, result);
+    return result;
+  }
 
-    shapesList.erase(shapesList.begin()); // Purge the header string
+  /**
+   * First half of parsePCBModuleString: the footprint itself, without its shapes. Gives the context and the
+   * string its shapes are to be parsed with, which parsePCBModuleShapes does.
+   */
+  PCB_Module* LCJSONSerializer::parsePCBModuleHeader(const pcbShapeContext &context, const fieldView &LCJSONString,
+                                                     nestedLibraryCache *exportedList, pcbShapeContext &moduleContext,
+                                                     fieldView &shapesString) const
+  {
+    fieldView headerString;
+    splitFirstByString(LCJSONString, "#@$", headerString, shapesString);
+    fieldList moduleHeader(headerString, '~');
 
-    result->id = moduleHeader[6]; // GGE ID.
-    result->uuid = moduleHeader[8]; // UUID; only for modules.
+    // Only for nested library use. If you pass a cache here, the UUID will be checked and make sure
+    // extra efforts were not wasted on an already-parsed component.
+    if(exportedList && exportedList->isDuplicate(moduleHeader[8], moduleHeader[6]))
+      return nullptr;
 
-    for(unsigned int i = 0; i < cparaTmp.size(); i += 2)
-      result->cparaContent[cparaTmp[i]] = cparaTmp[i + 1]; // Transfer c_para content
+    PCB_Module *result = createElement<PCB_Module>(context.owner->elementArena);
+    fieldTokenizer cparaTmp(moduleHeader[3], '`');
+    fieldView cparaKey, cparaValue;
+    StringPool &strings = context.owner->stringPool;
 
-    result->name = result->cparaContent["package"]; // Set package(aka footprint) name
+    result->id = moduleHeader[6].str(); // GGE ID.
+    result->uuid = moduleHeader[8].str(); // UUID; only for modules.
+
+    while(cparaTmp.next(cparaKey))
+    { // Transfer c_para content
+      if(!cparaTmp.next(cparaValue))
+        cparaValue = fieldView();
+      result->cparaContent.set(strings.intern(cparaKey), strings.intern(cparaValue));
+    }
+
+    result->name = result->cparaContent[strings.intern("package")]; // Set package(aka footprint) name
 
-    // Only for nested library use. If you pass an std::map here, UUID will be checked and make sure
-    // extra efforts were not wasted on an already-parsed component.
     if(exportedList) // Only do following when we *are* actually dealing with export nested libs
-      for(auto i = exportedList->begin(); i != exportedList->end(); i++) // Iterate through all the parsed footprints
-      {
-        if(i->first == result->uuid) // If found one with exact UUID then go out
-          return nullptr;
-        else
-        if(static_cast<PCB_Module*>(i->second->containedElements.back())->name == result->name)
-        { // If found that there's a footprint with the same name but they aren't actually the same one (which is tested possible)
-          Info("More than one footprint on this board was found called <<<" + result->name + ">>>(" +
-             result->id + "), gID will be added to the name.");
-          result->name += ("__" + result->id); // Modify the name for clarification
-        }
-      }
+      exportedList->add(moduleHeader[8], result->name, result->id);
 
-    result->moduleCoords =
-        (coordinates{stod(moduleHeader[1]), stod(moduleHeader[2])} - workingDocument->origin) * tenmils_to_mm_coefficient;
-    result->orientation = stod(moduleHeader[4] == "" ? "0" : moduleHeader[4]);
-    result->topLayer = stoi(moduleHeader[7]) == 1;
+    coordinates position { tolStod(moduleHeader[1]), tolStod(moduleHeader[2]) };
+    result->moduleCoords = (position - context.origin) * tenmils_to_mm_coefficient;
+    result->orientation = tolStod(moduleHeader[4]);
+    result->topLayer = tolStoi(moduleHeader[7]) == 1;
     result->layer = result->topLayer ? KiCadLayerIndex::F_Cu : KiCadLayerIndex::B_Cu;
     result->updateTime = (time_t)tolStoi(moduleHeader[9]);
 
-    processingModule = true;
-
-    if((workingDocument->docType == documentTypes::pcb) || (parent != nullptr))
-    {
-      coordinates originalOrigin = coordinates(workingDocument->origin);
-      workingDocument->origin = coordinates{stod(moduleHeader[1]), stod(moduleHeader[2])};
-      parsePCBLibComponent(shapesList, result->containedElements);
-      workingDocument->origin = originalOrigin;
-    }
-    else
-      parsePCBLibComponent(shapesList, result->containedElements);
-
-    processingModule = false;
+    // Shapes of a footprint are relative to its position, except inside footprint documents, where the
+    // document origin stays.
+    moduleContext = { context.owner, context.inModule ? context.origin : position, true };
 
-    return !++result;
+    return result;
   }
 
-  // Judgement member function of parsers
-
-  bool LCJSONSerializer::judgeIsOnCopperLayer(const KiCadLayerIndex layerKiCad)
+  void LCJSONSerializer::parsePCBModuleShapes(const pcbShapeContext &moduleContext, const fieldView &shapesString,
+                                              PCB_Module *module) const
   {
-    return layerKiCad >= F_Cu && layerKiCad <= B_Cu;
+    vector<fieldView> shapesList;
+    if(!shapesString.empty())
+      splitByString(shapesString, "#@$", shapesList);
+    parsePCBLibComponent(moduleContext, shapesList, module->containedElements);
   }
 
   /**
    * This part is for schematic elements serializing.
    */
 
-  Schematic_Pin* LCJSONSerializer::parseSchPin(const string &LCJSONString) const
+  Schematic_Pin* LCJSONSerializer::parseSchPin(const fieldView &LCJSONString) const
   {
-    RAIIC<Schematic_Pin> result;
-    string pinString = LCJSONString;
-    findAndReplaceString(pinString, "^^", "~"); //Double circumflex is bad design for us. We simply replace them
-    stringlist paramList = splitString(pinString, '~');
+    Schematic_Pin *result = createElement<Schematic_Pin>(elementOwner->elementArena);
+    fieldList paramList(LCJSONString, '~', "^^"); //Double circumflex is bad design for us. We simply treat them as separators
 
-    result->id = paramList[7]; //GGE ID.
+    result->id = paramList[7].str(); //GGE ID.
 
     //KiCad schematics uses mils for now. S-expression versions might take metric units.
     //EasyEDA uses the inversed direction in schematics against KiCad.
-    result->pinCoord = { (stod(paramList[4]) - workingDocument->origin.X) * schematic_unit_coefficient,
-               (stod(paramList[5]) - workingDocument->origin.Y) * -1 * schematic_unit_coefficient };
+    result->pinCoord = { (tolStod(paramList[4]) - workingDocument->origin.X) * schematic_unit_coefficient,
+               (tolStod(paramList[5]) - workingDocument->origin.Y) * -1 * schematic_unit_coefficient };
 
     // Pin electric property on EasyEDA didn't split power in and power out, so power would be treated as passive.
     result->electricProperty = SchPinElectricProperty(tolStoi(paramList[2]));
@@ -1300,12 +1550,12 @@ namespace lc2kicad
           result->pinRotation = SchematicRotations::Deg0; break;
       }
 
-    for(auto i = paramList[17].begin(); i < paramList[17].end(); i++)
+    result->pinName = paramList[17].str();
+    for(auto i = result->pinName.begin(); i < result->pinName.end(); i++)
       if(*i == ' ')
         *i = '_'; // KiCad schematics lib won't recognize space, even if you use semicolons.
 
-    result->pinName = paramList[17];
-    result->pinNumber = paramList[26];
+    result->pinNumber = elementOwner->stringPool.intern(paramList[26]);
 
     result->clock = paramList[34][0] == '1' ? true : false ;
     result->inverted = paramList[31][0] == '1' ? true : false ;
@@ -1314,8 +1564,9 @@ namespace lc2kicad
       result->fontSize = 50;
     else
     {
-      findAndReplaceString(paramList[20], "pt", "");
-      result->fontSize = paramList[20] == "" ? 50 : int (stod(paramList[20]) * (50.0f / 7.0f));
+      string fontSizeString = paramList[20].str();
+      findAndReplaceString(fontSizeString, "pt", "");
+      result->fontSize = fontSizeString == "" ? 50 : int (tolStod(fontSizeString) * (50.0f / 7.0f));
     }
 
     /*
@@ -1332,9 +1583,9 @@ namespace lc2kicad
 
     double pinLength = 0.0;
 
-    auto pinPath = SmolSVG::readPathString(paramList[11]);
-    const auto &drawPath = pinPath->getLastCommand();
-    SmolSVG::SmolCoord lengthVec = drawPath->getConstEndPoint() - drawPath->getConstStartPoint();
+    const SmolSVG::pathBuffer &pinPath = readSVGPath(paramList[11], result->id);
+    assertThrow(!pinPath.empty(), result->id + ": Pin path draws nothing.");
+    SmolSVG::SmolCoord lengthVec = pinPath.endPoint(pinPath.back()) - pinPath.startPoint(pinPath.back());
     if(fuzzyCompare(lengthVec.X, 0.0)) // X direction difference is 0
       pinLength = std::abs(lengthVec.Y);
     else
@@ -1342,101 +1593,96 @@ namespace lc2kicad
 
     result->pinLength = (pinLength + (result->inverted ? 6 : 0)) * sch_convert_coefficient;
 
-    return !++result;
+    return result;
   }
 
-  Schematic_Polyline* LCJSONSerializer::parseSchPolyline(const string &LCJSONString) const
+  Schematic_Polyline* LCJSONSerializer::parseSchPolyline(const fieldList &paramList) const
   {
-    RAIIC<Schematic_Polyline> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    Schematic_Polyline *result = createElement<Schematic_Polyline>(elementOwner->elementArena);
 
-    result->id = paramList[6];
+    result->id = paramList[6].str();
 
-    auto pointTemp = splitString(paramList[1], ' ');
-    for(unsigned int i = 0; i < pointTemp.size(); i += 2)
+    fieldTokenizer pointTemp(paramList[1], ' ');
+    fieldView pointX, pointY;
+    while(pointTemp.next(pointX) && pointTemp.next(pointY))
       result->polylinePoints.push_back(
-          coordinates((stod(pointTemp[i]) - workingDocument->origin.X) * schematic_unit_coefficient,
-                (stod(pointTemp[i + 1]) - workingDocument->origin.Y) * schematic_unit_coefficient * -1));
+          coordinates((tolStod(pointX) - workingDocument->origin.X) * schematic_unit_coefficient,
+                (tolStod(pointY) - workingDocument->origin.Y) * schematic_unit_coefficient * -1));
 
     result->isFilled = paramList[5] == "none" ? false : true;
-    result->lineWidth = int (stoi(paramList[3]) * schematic_unit_coefficient);
+    result->lineWidth = int (tolStoi(paramList[3]) * schematic_unit_coefficient);
 
-    return !++result;
+    return result;
   }
 
-  Schematic_Polygon* LCJSONSerializer::parseSchPolygon(const string &LCJSONString) const
+  Schematic_Polygon* LCJSONSerializer::parseSchPolygon(const fieldList &paramList) const
   {
-    RAIIC<Schematic_Polygon> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    Schematic_Polygon *result = createElement<Schematic_Polygon>(elementOwner->elementArena);
 
-    result->id = paramList[6];
+    result->id = paramList[6].str();
 
-    auto pointTemp = splitString(paramList[1], ' ');
-    for(unsigned int i = 0; i < pointTemp.size(); i += 2)
+    fieldTokenizer pointTemp(paramList[1], ' ');
+    fieldView pointX, pointY;
+    while(pointTemp.next(pointX) && pointTemp.next(pointY))
       result->polylinePoints.push_back(
-          coordinates((stod(pointTemp[i]) - workingDocument->origin.X) * schematic_unit_coefficient,
-                (stod(pointTemp[i + 1]) - workingDocument->origin.Y) * schematic_unit_coefficient * -1));
+          coordinates((tolStod(pointX) - workingDocument->origin.X) * schematic_unit_coefficient,
+                (tolStod(pointY) - workingDocument->origin.Y) * schematic_unit_coefficient * -1));
 
     result->isFilled = paramList[5] == "none" ? false : true;
-    result->lineWidth = int (stoi(paramList[3]) * schematic_unit_coefficient);
+    result->lineWidth = int (tolStoi(paramList[3]) * schematic_unit_coefficient);
 
-    return !++result;
+    return result;
   }
 
-  Schematic_Text* LCJSONSerializer::parseSchText(const string &LCJSONString) const
+  Schematic_Text* LCJSONSerializer::parseSchText(const fieldList &paramList) const
   {
-    RAIIC<Schematic_Text> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    Schematic_Text *result = createElement<Schematic_Text>(elementOwner->elementArena);
 
-    result->id = paramList[15];
+    result->id = paramList[15].str();
 
-    result->text = paramList[12];
+    result->text = paramList[12].str();
     result->bold = (paramList[9] == "normal" | paramList[9] == "") ? false : true;
     result->italic = (paramList[10] == "normal" | paramList[10] == "") ? false : true;
 
-    paramList[7].erase(paramList[7].end() - 2); //Remove "pt" characters
-    result->fontSize = stoi(paramList[7]);
+    result->fontSize = tolStoi(paramList[7]); // Trailing "pt" characters are ignored by the conversion
 
-    result->position = { stod(paramList[2]) * schematic_unit_coefficient, //We output the file as left justified, so this is fine.
-               (stod(paramList[3]) - 0.5 * result->fontSize) * -1 * schematic_unit_coefficient };
+    result->position = { tolStod(paramList[2]) * schematic_unit_coefficient, //We output the file as left justified, so this is fine.
+               (tolStod(paramList[3]) - 0.5 * result->fontSize) * -1 * schematic_unit_coefficient };
 
-    return !++result;
+    return result;
   }
 
-  Schematic_Rect* LCJSONSerializer::parseSchRect(const string &LCJSONString) const
+  Schematic_Rect* LCJSONSerializer::parseSchRect(const fieldList &paramList) const
   {
-    RAIIC<Schematic_Rect> result;
-    stringlist paramList = splitString(LCJSONString, '~');
+    Schematic_Rect *result = createElement<Schematic_Rect>(elementOwner->elementArena);
 
-    result->id = paramList[11];
-    result->position = { (stoi(paramList[1]) - static_cast<int>(workingDocument->origin.X)) * schematic_unit_coefficient,
-               (stoi(paramList[2]) - static_cast<int>(workingDocument->origin.Y)) * schematic_unit_coefficient * -1 };
-    result->size = { stoi(paramList[5]) * schematic_unit_coefficient, stoi(paramList[6]) * schematic_unit_coefficient };
+    result->id = paramList[11].str();
+    result->position = { (tolStoi(paramList[1]) - static_cast<int>(workingDocument->origin.X)) * schematic_unit_coefficient,
+               (tolStoi(paramList[2]) - static_cast<int>(workingDocument->origin.Y)) * schematic_unit_coefficient * -1 };
+    result->size = { tolStoi(paramList[5]) * schematic_unit_coefficient, tolStoi(paramList[6]) * schematic_unit_coefficient };
     result->isFilled = paramList[10] == "none" ? false : true;
-    result->width = int (stoi(paramList[8]) * schematic_unit_coefficient);
+    result->width = int (tolStoi(paramList[8]) * schematic_unit_coefficient);
 
-    return !++result;
+    return result;
   }
 
 
-  Schematic_Arc *LCJSONSerializer::parseSchArc(const string &LCJSONString) const
+  Schematic_Arc *LCJSONSerializer::parseSchArc(const fieldList &paramList) const
   {
-    RAIIC<Schematic_Arc> result;
-    stringlist paramList = splitString(LCJSONString, '~'), arcCmdParams, movetoCmdParams;
+    Schematic_Arc *result = createElement<Schematic_Arc>(elementOwner->elementArena);
 
-    result->id = paramList[7];
+    result->id = paramList[7].str();
     result->isFilled = paramList[6] == "none" ? false : true;
-    result->width = int (stoi(paramList[4]) * schematic_unit_coefficient);
+    result->width = int (tolStoi(paramList[4]) * schematic_unit_coefficient);
 
-    auto path = SmolSVG::readPathString(paramList[1]);
-    coordinates startpoint = path->getLastCommand()->getConstStartPoint(),
-            endpoint = path->getLastCommand()->getConstEndPoint();
-    auto &smolArcCmd = *(static_cast<SmolSVG::commandEllipticalArcTo*>(path->getLastCommand()));
-    auto &size = smolArcCmd.getRadii();
+    const SmolSVG::pathBuffer *path;
+    const SmolSVG::pathBuffer::segment &arc = readSVGArc(paramList[1], result->id, path);
+    coordinates startpoint = path->startPoint(arc), endpoint = path->endPoint(arc);
+    auto &size = path->radii(arc);
 
-    centerArc resultArc = svgEllipticalArcComputation(startpoint.X, startpoint.Y, smolArcCmd.getRadii().X,
-                                                      smolArcCmd.getRadii().Y, smolArcCmd.getXAxisRotation(), smolArcCmd.getLargeArc(),
-                                                      smolArcCmd.getFlagSweep(), endpoint.X, endpoint.Y);
+    centerArc resultArc = svgEllipticalArcComputation(startpoint.X, startpoint.Y, path->radii(arc).X,
+                                                      path->radii(arc).Y, arc.XAxisRotation, arc.largeArc,
+                                                      arc.sweep, endpoint.X, endpoint.Y);
 
     double angle1 = fmod(resultArc.angleStart, 360.0), angle2 = fmod(resultArc.angleStart + resultArc.angleExtend, 360.0);
 
@@ -1453,46 +1699,47 @@ namespace lc2kicad
 
     result->center.Y *= -1, result->startPoint.Y *= -1, result->endPoint.Y *= -1;
 
-    return !++result;
+    return result;
   }
 
-  Schematic_Module *LCJSONSerializer::parseSchModuleString(const std::string &LCJSONString, EDADocument *parent,
-                                                           map<std::string, RAIIC<EDADocument> > *exportedList)
+  Schematic_Module *LCJSONSerializer::parseSchModuleString(const fieldView &LCJSONString, EDADocument *parent,
+                                                           nestedLibraryCache *exportedList)
   {
-    RAIIC<Schematic_Module> result;
-    stringlist shapesList = splitByString(LCJSONString, string("#@$")),
-        moduleHeader = splitString(shapesList[0], '~'),
-        cparaTmp = splitString(moduleHeader[3], '`');
+    fieldView headerString, shapesString;
+    bool hasShapes = splitFirstByString(LCJSONString, "#@$", headerString, shapesString);
+    fieldList moduleHeader(headerString, '~');
 
-    shapesList.erase(shapesList.begin()); // Purge the header string
-
-    result->id = moduleHeader[6];
-    result->uuid = moduleHeader[8];
+    // Only for nested library use. If you pass a cache here, the UUID will be checked and make sure
+    // extra efforts were not wasted on an already-parsed component.
+    if(exportedList && exportedList->isDuplicate(moduleHeader[8], moduleHeader[6]))
+      return nullptr;
 
-    for(unsigned int i = 0; i < cparaTmp.size(); i += 2)
-      result->cparaContent[cparaTmp[i]] = cparaTmp[i + 1]; // Transfer c_para content
+    Schematic_Module *result = createElement<Schematic_Module>(elementOwner->elementArena);
+    vector<fieldView> shapesList;
+    if(hasShapes)
+      splitByString(shapesString, "#@$", shapesList);
+    fieldTokenizer cparaTmp(moduleHeader[3], '`');
+    fieldView cparaKey, cparaValue;
+    StringPool &strings = elementOwner->stringPool;
+
+    result->id = moduleHeader[6].str();
+    result->uuid = moduleHeader[8].str();
+
+    while(cparaTmp.next(cparaKey))
+    { // Transfer c_para content
+      if(!cparaTmp.next(cparaValue))
+        cparaValue = fieldView();
+      result->cparaContent.set(strings.intern(cparaKey), strings.intern(cparaValue));
+    }
 
-    result->name = result->cparaContent["Manufacturer Part"]; // Set symbol name
+    result->name = result->cparaContent[strings.intern("Manufacturer Part")]; // Set symbol name
 
-    // Only for nested library use. If you pass an std::map here, UUID will be checked and make sure
-    // extra efforts were not wasted on an already-parsed component.
     if(exportedList) // Only do following when we *are* actually dealing with export nested libs
-      for(auto i = exportedList->begin(); i != exportedList->end(); i++) // Iterate through all the parsed symbols
-      {
-        if(i->first == result->uuid) // If found one with exact UUID then go out
-          return nullptr;
-        else
-        if(static_cast<Schematic_Module*>(i->second->containedElements.back())->name == result->name)
-        { // If found that there's a symbol with the same name but they aren't actually the same one (which is tested possible)
-          Info("More than one footprint on this board was found called <<<" + result->name + ">>>(" +
-             result->id + "), gID will be added to the name.");
-          result->name += ("__" + result->id); // Modify the name for clarification
-        }
-      }
+      exportedList->add(moduleHeader[8], result->name, result->id);
 
     result->moduleCoords =
-        (coordinates{stod(moduleHeader[1]), stod(moduleHeader[2])} - workingDocument->origin) * tenmils_to_mm_coefficient;
-    result->orientation = stod(moduleHeader[4] == "" ? "0" : moduleHeader[4]);
+        (coordinates{tolStod(moduleHeader[1]), tolStod(moduleHeader[2])} - workingDocument->origin) * tenmils_to_mm_coefficient;
+    result->orientation = tolStod(moduleHeader[4]);
     result->updateTime = (time_t)tolStoi(moduleHeader[9]);
 
 
@@ -1501,7 +1748,7 @@ namespace lc2kicad
     if((workingDocument->docType == documentTypes::schematic) || (parent != nullptr))
     {
       coordinates originalOrigin = coordinates(workingDocument->origin);
-      workingDocument->origin = coordinates{stod(moduleHeader[1]), stod(moduleHeader[2])};
+      workingDocument->origin = coordinates{tolStod(moduleHeader[1]), tolStod(moduleHeader[2])};
       parseSchLibComponent(shapesList, result->containedElements);
       workingDocument->origin = originalOrigin;
     }
@@ -1510,6 +1757,6 @@ namespace lc2kicad
 
     processingModule = false;
 
-    return !++result;
+    return result;
   }
 }
@@ -21,15 +21,22 @@
 #include <vector>
 #include <fstream>
 #include <ctime>
+#include <cstdio>
+#include <algorithm>
+#include <sstream>
 
 #include "consts.hpp"
 #include "includes.hpp"
 #include "rapidjson.hpp"
-#include "rapidjson/istreamwrapper.h"
+#include "inputbuffer.hpp"
+#include "streamreader.hpp"
+#include "logger.hpp"
+#include "outputbuffer.hpp"
 #include "edaclasses.hpp"
 #include "lc2kicadcore.hpp"
 #include "internalsserializer.hpp"
 #include "internalsdeserializer.hpp"
+#include "conversioncache.hpp"
 
 using std::cout;
 using std::cerr;
@@ -41,7 +48,6 @@ using std::stof;
 using std::stoi;
 using std::to_string;
 using std::runtime_error;
-using rapidjson::FileReadStream;
 using rapidjson::Document;
 using rapidjson::Value;
 
@@ -89,13 +95,34 @@ namespace lc2kicad
                                      // Will be constructing a new one in the switch case.
     tempTargetDoc.pathToFile = filePath; // Just for storage so the document will know who he is.
     tempTargetDoc.parent = this; // Set parent. Currently used for deserializer referencing.
+    setLogContext(filePath);
 
-    char readBuffer[BUFSIZ]; // Create the buffer for RapidJSON to read the file
-    std::FILE *parseTarget = std::fopen(filePath.c_str(), "r");
-    assertThrow(parseTarget != 0, "File \"" + filePath + "\" couldn't be opened. Parse of this file is aborted.");
-    FileReadStream fileReader(parseTarget, readBuffer, BUFSIZ);
-    tempTargetDoc.jsonParseResult->ParseStream(fileReader); // Let RapidJSON parse JSON file
-    std::fclose(parseTarget);
+    if(coreParserArguments["SPM"] != 0.0) // Streaming parse mode
+    {
+      std::FILE *file = std::fopen(filePath.c_str(), "rb");
+      assertThrow(file != nullptr, "Cannot open file \"" + filePath + "\".");
+      bool streamed;
+      try
+      {
+        streamed = streamLCFile(file, tempTargetDoc, ret);
+      }
+      catch(...)
+      {
+        std::fclose(file);
+        for(auto &i : ret)
+          delete i;
+        throw;
+      }
+      std::fclose(file);
+      if(streamed)
+        return ret;
+      Info("\"" + filePath + "\" can't be streamed, parsing it as a whole.");
+    }
+
+    // Map the file and let RapidJSON parse it in-situ. Strings in the DOM will point into the mapping,
+    // which is shared by every document derived from this one.
+    tempTargetDoc.inputBuffer = InputFileBuffer::mapFile(filePath);
+    tempTargetDoc.jsonParseResult->ParseInsitu(tempTargetDoc.inputBuffer->data());
 
     // Create a reference to the JSON parse result for convenience
     // (Actually also cause I don't want to change the code structure)
@@ -119,19 +146,38 @@ namespace lc2kicad
   {
     list<EDADocument*> ret;
     EDADocument tempTargetDoc(true);
+    setLogContext("-");
 
-    rapidjson::IStreamWrapper cinwrapper(std::cin);
-    tempTargetDoc.jsonParseResult->ParseStream(cinwrapper); // Parse from stdin
+    if(coreParserArguments["SPM"] != 0.0) // Streaming parse mode. Standard input can't be rewound, so no fallback.
+    {
+      try
+      {
+        assertThrow(streamLCFile(stdin, tempTargetDoc, ret),
+                    "Standard input is not a single EasyEDA document and can't be streamed.");
+      }
+      catch(...)
+      {
+        for(auto &i : ret)
+          delete i;
+        throw;
+      }
+    }
+    else
+    {
+    // Standard input can't be mapped; read it whole, then parse it in-situ like we do for files.
+      tempTargetDoc.inputBuffer = InputFileBuffer::readStream(std::cin);
+      tempTargetDoc.jsonParseResult->ParseInsitu(tempTargetDoc.inputBuffer->data());
 
-    Document& parseTargetDoc = *tempTargetDoc.jsonParseResult;
-    
-    assertThrow(!parseTargetDoc.HasParseError(),
-                string("RapidJSON reported error when parsing the file. Error code: ") +
-                rapidjsonErrorMsg[parseTargetDoc.GetParseError()] + ", offset " +
-                to_string(parseTargetDoc.GetErrorOffset()) + ".\n"
-                );
+      Document& parseTargetDoc = *tempTargetDoc.jsonParseResult;
 
-    parseJsonAsEasyEDA6File(tempTargetDoc, ret);
+      assertThrow(!parseTargetDoc.HasParseError(),
+                  string("RapidJSON reported error when parsing the file. Error code: ") +
+                  rapidjsonErrorMsg[parseTargetDoc.GetParseError()] + ", offset " +
+                  to_string(parseTargetDoc.GetErrorOffset()) + ".\n"
+                  );
+
+      parseJsonAsEasyEDA6File(tempTargetDoc, ret);
+    }
 
     // Piped conversion can only handle single input and print single output file,
     // So we'll fail if we have multiple ones.
@@ -145,6 +191,34 @@ namespace lc2kicad
     return ret.front();
   }
 
+  /*
+   * Streaming parse mode. Only head, canvas and DRC rules of the document are kept in memory; shapes are
+   * handed to the serializer one by one as they are read from the file.
+   *
+   * Returns false, with nothing parsed, if the input turns out not to be a single document (e.g. a
+   * schematics project). The caller may then parse it as a whole if the input can be read again.
+   */
+  bool LC2KiCadCore::streamLCFile(std::FILE *file, EDADocument &aTargetDoc, list<EDADocument *> &ret)
+  {
+    EasyEDAStreamReader reader(file);
+    if(!reader.readHeader())
+      return false;
+
+    aTargetDoc.jsonParseResult = reader.headerDocument();
+    internalSerializer->attachShapeStream(&reader);
+    try
+    {
+      parseJsonAsEasyEDA6File(aTargetDoc, ret);
+    }
+    catch(...)
+    {
+      internalSerializer->attachShapeStream(nullptr);
+      throw;
+    }
+    internalSerializer->attachShapeStream(nullptr);
+    return true;
+  }
+
   /*
    * Provide an internal document object and parse it as a EasyEDA 6 document file.
    * Note that the jsonParseResult member should be a valid one. Or else, the program will read and parse JSON
@@ -163,7 +237,7 @@ namespace lc2kicad
     else
       cerr << ". EasyEDA Editor version unknown.\n";
       */
-    cerr << "[Auto Parser] Read input document \"" << aTargetDoc.pathToFile << "\" as EasyEDA 6 document...\n";
+    cerr << "[Auto Parser] Read input document \"" + aTargetDoc.pathToFile + "\" as EasyEDA 6 document...\n";
 
     string filename = base_name(string(aTargetDoc.pathToFile));
 
@@ -209,6 +283,8 @@ namespace lc2kicad
 
 
     // Now decide what are we going to parse, whether schematics or PCB, anything else.
+    // The documents created here share the parent's DOM (and its allocator) and only borrow aDocObject,
+    // which may be a page nested deep in it. Nothing is copied.
     //PCBDocument* targetDoc = new PCBDocument(targetInternalDoc); // Deprecated
     RAIIC<EDADocument> targetDocument(nullptr);
     switch(documentType)
@@ -216,9 +292,7 @@ namespace lc2kicad
       case 1:
       {
         targetDocument.replace(new SchematicDocument(*aBasicDocument));
-        Document *realDocument = new Document;
-        realDocument->SetObject() = aDocObject;
-        targetDocument->jsonParseResult = shared_ptr<Document>(realDocument);
+        targetDocument->jsonObject = &aDocObject;
         if(coreParserArguments.count("ENL"))
         {
           internalSerializer->initWorkingDocument(!targetDocument);
@@ -234,9 +308,10 @@ namespace lc2kicad
       }
       case 2:
       {
-        targetDocument.replace(new SchematicDocument(*aBasicDocument)); // FIXME: Do not copy JSON result around?
+        targetDocument.replace(new SchematicDocument(*aBasicDocument));
+        targetDocument->jsonObject = &aDocObject;
         targetDocument->module = true;
-        targetDocument->containedElements.push_back(new Schematic_Module);
+        targetDocument->containedElements.push_back(createElement<Schematic_Module>(targetDocument->elementArena));
 
         internalSerializer->initWorkingDocument(!targetDocument);
         internalSerializer->parseSchLibDocument();
@@ -248,6 +323,7 @@ namespace lc2kicad
       case 3:
       {
         targetDocument.replace(new PCBDocument(*aBasicDocument));
+        targetDocument->jsonObject = &aDocObject;
         if(coreParserArguments.count("ENL"))
         {
           internalSerializer->initWorkingDocument(!targetDocument);
@@ -268,8 +344,9 @@ namespace lc2kicad
       case 4:
       {
         targetDocument.replace(new PCBDocument(*aBasicDocument));
+        targetDocument->jsonObject = &aDocObject;
         targetDocument->module = true;
-        targetDocument->containedElements.push_back(new PCB_Module);
+        targetDocument->containedElements.push_back(createElement<PCB_Module>(targetDocument->elementArena));
 
         internalSerializer->initWorkingDocument(!targetDocument);
         internalSerializer->parsePCBLibDocument(); //Exceptions will be thrown out of the function. Dynamic memory will be released by RAIIC
@@ -305,17 +382,22 @@ namespace lc2kicad
     }
   }
 
-  void LC2KiCadCore::deserializeFile(EDADocument* target, string* path)
+  /*
+   * Write a document out. Returns the name of the file written, or an empty string if the document went to the
+   * standard output instead. With capture, the document is made in memory first and also handed back there.
+   */
+  string LC2KiCadCore::deserializeFile(EDADocument* target, string* path, string *capture)
   {
     std::ofstream outputfile;
     std::ostream *outputStream = &cout;
-    string* tempResult, outputFileName;
-        
+    string outputFileName;
+
+    setLogContext(target->pathToFile);
     if(!argParseResult.usePipe)
     {
       outputFileName = *path + target->docInfo["documentname"] + documentExtensionName[target->docType];
       sanitizeFileName(outputFileName);
-      cerr << "[Deserializer] Write file \"" << outputFileName << "\"...\n";
+      cerr << "[Deserializer] Write file \"" + outputFileName + "\"...\n";
       outputfile.open(outputFileName, std::ios::out);
       if(!outputfile) // Dont error with pipe IO
         Error("[Deserializer] Cannot create file for this document. File content would be written into"
@@ -324,33 +406,101 @@ namespace lc2kicad
         outputStream = &outputfile;
     }
     
-    internalDeserializer->initWorkingDocument(target);
+    // Deserializers write straight into this buffer, which goes to the file in large chunks.
+    std::ostringstream captureStream;
+    OutputBuffer output(capture ? captureStream : *outputStream);
+    if(coreParserArguments["ODP"] > 0) // Output Decimal Places
+      output.setDecimalPlaces(static_cast<unsigned int>(coreParserArguments["ODP"]));
 
-    // Deserializer output are pointers to dynamic memory. They must be freed manually.
+    internalDeserializer->initWorkingDocument(target);
 
     // Headers
-    tempResult = internalDeserializer->outputFileHeader();
-    *outputStream << *tempResult << endl;
-    delete tempResult;
+    internalDeserializer->outputFileHeader(output);
 
     for(auto &i : target->containedElements)
     {
       if(!i) continue;
-      try { tempResult = i->deserializeSelf(*internalDeserializer); }
+      try { internalDeserializer->outputElement(*i, output); }
       catch(std::runtime_error &e)
       {
         Error(string("[Deserializer] Unexpected error outputting a component: ") + e.what());
       }
+    }
 
-      *outputStream << *tempResult << endl;
-      delete tempResult;
+    internalDeserializer->outputFileEnding(output);
+    output.flush();
+    if(capture)
+    {
+      *capture = captureStream.str();
+      outputStream->write(capture->data(), static_cast<std::streamsize>(capture->size()));
     }
+    outputStream->flush();
+    if(!*outputStream)
+      Error("[Deserializer] Cannot write file \"" + outputFileName + "\".");
 
-    tempResult = internalDeserializer->outputFileEnding();
-    *outputStream << *tempResult << endl;
-    delete tempResult;
+    VERBOSE_INFO("[Deserializer] Element arena high-water mark: " + to_string(target->elementArena.highWaterMark()) +
+                 " bytes.");
 
     if(!outputfile)
       outputfile.close();
+
+    return outputStream == &outputfile ? outputFileName : string();
+  }
+
+  /*
+   * Convert one input file through the persistent conversion cache, writing its documents right away. On a hit
+   * the recorded output files are written again, and neither the serializer nor the deserializer runs. On a miss
+   * the file is converted as usual, and its output is recorded unless something went wrong on the way, or
+   * another input of this run wrote a file of the same name.
+   */
+  void LC2KiCadCore::convertFileCached(string &filePath, string &outputPath)
+  {
+    vector<ConversionCache::outputFile> outputs;
+    string key;
+    {
+      std::shared_ptr<InputFileBuffer> input = InputFileBuffer::mapFile(filePath);
+      key = conversionCache->makeKey(base_name(filePath), input->data(), input->size());
+    }
+
+    setLogContext(filePath);
+    if(conversionCache->load(key, outputs))
+    {
+      for(auto &i : outputs)
+      {
+        string outputFileName = outputPath + i.name;
+        conversionCache->claimOutput(outputFileName, filePath);
+        cerr << "[Cache] Write file \"" + outputFileName + "\" from cache...\n";
+        std::ofstream outputFile(outputFileName, std::ios::out | std::ios::binary);
+        if(!outputFile.write(i.content.data(), i.content.size()))
+          Error("[Cache] Cannot write file \"" + outputFileName + "\".");
+      }
+      return;
+    }
+
+    long errorCount = loggedErrorCount();
+    bool cacheable = true;
+    list<EDADocument*> docList = autoParseLCFile(filePath);
+
+    for(auto &i : docList)
+      if(i)
+      {
+        try
+        {
+          string content, outputFileName = deserializeFile(i, &outputPath, &content);
+          cacheable &= !outputFileName.empty() && conversionCache->claimOutput(outputFileName, filePath);
+          outputs.push_back({ outputFileName.substr(std::min(outputPath.size(), outputFileName.size())),
+                              std::move(content) });
+        }
+        catch(std::exception &e)
+        {
+          Error(string("Writing a document of \"") + filePath + "\" failed with exception: " + e.what());
+          cacheable = false;
+        }
+        delete i;
+      }
+
+    // Don't record a conversion that logged errors, it should show them again.
+    if(cacheable && !outputs.empty() && loggedErrorCount() == errorCount)
+      conversionCache->store(key, outputs);
   }
 }
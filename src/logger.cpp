@@ -0,0 +1,246 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "includes.hpp"
+#include "rapidjson.hpp"
+#include "rapidjson/stringbuffer.h"
+#include "logger.hpp"
+
+#ifdef USE_WINAPI_FOR_TEXT_COLOR
+#include <windows.h>
+#endif
+
+using std::string;
+
+namespace lc2kicad
+{
+  extern programArgumentParseResult argParseResult;
+#ifdef USE_WINAPI_FOR_TEXT_COLOR
+  extern HANDLE hStdOut;
+  extern CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
+  extern WORD wBackgroundColor;
+#endif
+
+  namespace
+  {
+    const size_t bufferedMessages = 64;
+    const unsigned repeatLimit = 10;
+
+    struct logEntry
+    {
+      logLevel level;
+      string message;
+      size_t suppressed; // Non-zero for the summary line of a suppressed group
+      bool console; // False for messages past the repeat limit, which only go into the JSON log
+    };
+
+    // Shared sinks. Only touched with sinkMutex held.
+    std::mutex sinkMutex;
+    std::ostream *consoleStream = &std::cout;
+    std::ofstream jsonStream;
+    std::atomic<bool> jsonEnabled(false);
+
+    struct repeatGroup
+    {
+      logLevel level;
+      std::atomic<size_t> count {0}; // Times logged since the last flushLog(), by all threads
+    };
+
+    // Groups are never taken out, so threads can keep pointers to them and only lock to find new ones.
+    // The map is only touched with repeatMutex held; the counts of the groups in it are atomic.
+    std::mutex repeatMutex;
+    std::unordered_map<string, repeatGroup> repeats;
+
+    std::atomic<long> errorCount(0), warningCount(0);
+
+    // Groups "gge123: Copper track on footprint." with every other track by skipping the element ID.
+    // False for messages not of that form, which aren't grouped.
+    bool groupKey(const string &message, string &key)
+    {
+      size_t colon = message.find(": ");
+      if(colon == string::npos || colon == 0 || message.find(' ') < colon)
+        return false;
+      key.assign(message, colon + 2, string::npos);
+      return true;
+    }
+
+    void writeConsole(const logEntry &entry)
+    {
+      static const char *prefixes[] = { "Error: ", "Warning: ", "Info: " };
+      string text = entry.suppressed ?
+                      std::to_string(entry.suppressed) + " more similar message(s) suppressed: " + entry.message :
+                      entry.message;
+#ifdef USE_WINAPI_FOR_TEXT_COLOR
+      static const WORD colors[] = { FOREGROUND_RED | FOREGROUND_INTENSITY,
+                                     FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY,
+                                     FOREGROUND_BLUE | FOREGROUND_INTENSITY };
+      GetConsoleScreenBufferInfo(hStdOut, &consoleInfo);
+      wBackgroundColor = consoleInfo.wAttributes & (BACKGROUND_RED | BACKGROUND_GREEN | BACKGROUND_BLUE | BACKGROUND_INTENSITY );
+      SetConsoleTextAttribute(hStdOut, colors[static_cast<int>(entry.level)] | wBackgroundColor);
+      *consoleStream << prefixes[static_cast<int>(entry.level)] << text << std::endl;
+      SetConsoleTextAttribute(hStdOut, consoleInfo.wAttributes);
+#else
+      static const char *colors[] = { "\033[1;31m", "\033[1;93m", "\033[1;96m" };
+      *consoleStream << colors[static_cast<int>(entry.level)] << prefixes[static_cast<int>(entry.level)]
+                     << text << "\033[39m\n";
+#endif
+    }
+
+    void writeJSON(const logEntry &entry, const string &context)
+    {
+      static const char *levelNames[] = { "error", "warning", "info" };
+      rapidjson::StringBuffer line;
+      rapidjson::Writer<rapidjson::StringBuffer> writer(line);
+
+      writer.StartObject();
+      writer.Key("level");
+      writer.String(levelNames[static_cast<int>(entry.level)]);
+      if(!context.empty())
+      {
+        writer.Key("file");
+        writer.String(context.c_str(), static_cast<rapidjson::SizeType>(context.size()));
+      }
+      writer.Key("message");
+      writer.String(entry.message.c_str(), static_cast<rapidjson::SizeType>(entry.message.size()));
+      writer.EndObject();
+
+      jsonStream << line.GetString() << '\n';
+    }
+
+    struct threadLog
+    {
+      std::vector<logEntry> entries;
+      std::unordered_map<string, repeatGroup*> groups; // The shared groups this thread has logged into
+      string context;
+
+      void write()
+      {
+        if(entries.empty())
+          return;
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        for(auto &i : entries)
+        {
+          if(i.console)
+            writeConsole(i);
+          if(jsonStream.is_open() && !i.suppressed) // The JSON log has every message, so no summaries
+            writeJSON(i, context);
+        }
+        consoleStream->flush();
+        entries.clear();
+      }
+
+      // Summarize the groups that went past the limit, once, whichever thread logged them, and start over
+      void flush()
+      {
+        {
+          std::lock_guard<std::mutex> lock(repeatMutex);
+          for(auto &i : repeats)
+          {
+            size_t count = i.second.count.exchange(0);
+            if(count > repeatLimit)
+              entries.push_back({ i.second.level, i.first, count - repeatLimit, true });
+          }
+        }
+        write();
+      }
+
+      ~threadLog() { write(); }
+    };
+
+    threadLog& localLog()
+    {
+      thread_local threadLog log;
+      return log;
+    }
+  }
+
+  void logMessage(logLevel level, const string &message)
+  {
+    if(level == logLevel::error)
+      errorCount++;
+    else if(level == logLevel::warning)
+      warningCount++;
+
+    threadLog &log = localLog();
+    bool shown = true;
+    string key;
+    if(level != logLevel::error && !argParseResult.verboseInfo && groupKey(message, key))
+    {
+      repeatGroup *&group = log.groups[key];
+      if(!group)
+      {
+        std::lock_guard<std::mutex> lock(repeatMutex);
+        group = &repeats[key];
+        group->level = level;
+      }
+      shown = ++group->count <= repeatLimit;
+    }
+    if(!shown && !jsonEnabled)
+      return;
+
+    log.entries.push_back({ level, message, 0, shown });
+    if(level == logLevel::error || log.entries.size() >= bufferedMessages)
+      log.write();
+  }
+
+  void flushLog() { localLog().flush(); }
+
+  void setLogStream(std::ostream *stream)
+  {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    consoleStream = stream;
+  }
+
+  bool openJSONLog(const string &path)
+  {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    jsonStream.open(path, std::ios::out | std::ios::trunc);
+    jsonEnabled = jsonStream.is_open();
+    return jsonEnabled;
+  }
+
+  void setLogContext(const string &inputFile)
+  {
+    threadLog &log = localLog();
+    log.write(); // Queued messages belong to the previous step
+    log.context = inputFile;
+  }
+
+  string logContext() { return localLog().context; }
+
+  long loggedErrorCount() { return errorCount; }
+  long loggedWarningCount() { return warningCount; }
+
+  void Error(std::string s) { logMessage(logLevel::error, s); }
+  void Warn(std::string s) { logMessage(logLevel::warning, s); }
+  void Info(std::string s) { logMessage(logLevel::info, s); }
+
+  void InfoVerbose(std::function<std::string()> sf)
+  {
+    if(!argParseResult.verboseInfo) return;
+    Info(sf());
+  }
+}
@@ -20,12 +20,15 @@
 #include <iostream>
 #include <vector>
 #include <fstream>
-
+#include <memory>
 
 #include "includes.hpp"
 #include "lc2kicad.hpp"
 #include "edaclasses.hpp"
 #include "lc2kicadcore.hpp"
+#include "conversionpool.hpp"
+#include "conversioncache.hpp"
+#include "logger.hpp"
 
 #include "floatint.hpp"
 
@@ -47,8 +50,6 @@ namespace lc2kicad
   void displayAbout();
   void displayUsage();
   programArgumentParseResult argParseResult;
-  long errorCount = 0, warningCount = 0;
-  std::ostream* logstream = nullptr;
 #ifdef USE_WINAPI_FOR_TEXT_COLOR
   HANDLE hStdOut;
   CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
@@ -70,7 +71,10 @@ int main(int argc, const char** argv)
 
 #endif
 
-  logstream = argParseResult.usePipe ? &std::cerr : &std::cout;
+  if(argParseResult.usePipe)
+    setLogStream(&std::cerr); // Standard output carries the converted document
+  if(argParseResult.logFile.size() && !openJSONLog(argParseResult.logFile))
+    Error("Cannot open log file \"" + argParseResult.logFile + "\".");
 
   if(argParseResult.verboseInfo)
     argParseResult.verboseOutputArgParseResult(&argParseResult);
@@ -96,7 +100,36 @@ int main(int argc, const char** argv)
     exit(1);
   }
   
-  if(!argParseResult.usePipe) // When using file IO; mostly this case
+  std::unique_ptr<ConversionCache> cache;
+  const str_dbl_map &parserArguments = argParseResult.parserArguments;
+  if(!argParseResult.usePipe && parserArguments.count("CACHE") && parserArguments.at("CACHE") != 0.0) // Persistent cache
+  {
+    double sizeLimit = parserArguments.count("CACHESIZE") ? parserArguments.at("CACHESIZE") : 0; // In MiB
+    cache.reset(new ConversionCache(argParseResult.cacheDirectory.size() ? argParseResult.cacheDirectory
+                                                                          : ConversionCache::defaultDirectory(),
+                                    static_cast<unsigned long long>((sizeLimit > 0 ? sizeLimit : 256) * 1048576),
+                                    parserArguments));
+    core.setConversionCache(cache.get());
+  }
+
+  if(!argParseResult.usePipe && argParseResult.jobCount > 1) // Convert files on multiple workers
+  {
+    ConversionPool pool(argParseResult.parserArguments, argParseResult.jobCount, cache.get());
+    pool.convertFiles(argParseResult.filenames, path);
+  }
+  else if(cache) // One file after another, written out before the next one is read
+  {
+    for(auto &i : argParseResult.filenames)
+    {
+      try { core.convertFileCached(i, path); }
+      catch(std::runtime_error &e)
+      {
+        Error(string("Parsing for \"") + i + "\" failed with exception: " + e.what());
+      }
+      flushLog();
+    }
+  }
+  else if(!argParseResult.usePipe) // When using file IO; mostly this case
   {
     for(auto &i : argParseResult.filenames)
       try
@@ -113,7 +146,7 @@ int main(int argc, const char** argv)
 
     for(auto &i : documentCacheList)
       if(i)
-        core.deserializeFile(i, &path), delete i;
+        core.deserializeFile(i, &path), delete i, flushLog();
   }
   else // When using piped IO
   {
@@ -131,11 +164,23 @@ int main(int argc, const char** argv)
       core.deserializeFile(i, &path), delete i;
   }
 
-  *logstream << endl;
+  if(cache)
+  {
+    cache->trim();
+    cache->reportStatistics();
+  }
+
+  flushLog();
+  long errorCount = loggedErrorCount(), warningCount = loggedWarningCount();
+  std::ostream &summaryStream = argParseResult.usePipe ? std::cerr : std::cout;
+  summaryStream << endl;
   if(errorCount | warningCount)
+  {
     Warn(string("Error(s): ") + to_string(errorCount) + ", warning(s): " + to_string(warningCount) + ".");
+    flushLog();
+  }
   else
-    *logstream << "Error(s): " << errorCount << ", warning(s): " << warningCount << ".\n";
+    summaryStream << "Error(s): " << errorCount << ", warning(s): " << warningCount << ".\n";
 
   return 0;
 }
@@ -151,7 +196,10 @@ namespace lc2kicad
           "  -h, --help:     Display this help message and quit.\n"
           "      --version:  Display about message.\n"
           "  -a [ARGS]:      Specify parser arguments; see documentation for details.\n"
-          "  -l:             Export nested libraries from a document.\n";
+          "  -l:             Export nested libraries from a document.\n"
+          "  -j [N]:         Convert up to N files at the same time.\n"
+          "      --log-json [FILE]: Also write messages into FILE as JSON lines.\n"
+          "      --cache-dir [DIR]: Keep the conversion cache (-a CACHE:1) in DIR.\n";
   }
 
   void displayAbout()
@@ -0,0 +1,163 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdint>
+#include <climits>
+#include <limits>
+
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/internal/strtod.h"
+#include "numberdecoder.hpp"
+
+namespace lc2kicad
+{
+  namespace
+  {
+    // RapidJSON doesn't look at more digits than this either; they can't change the rounded result.
+    const int maxDecimalDigits = 768;
+    // Keeps the decimal exponent far away from int overflow. Anything this large is 0 or inf anyway.
+    const int maxExponentMagnitude = 100000;
+
+    const double exactPowersOfTen[] =
+    {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    const char* skipSpacesAndSign(const char *cursor, const char *last, bool &minus)
+    {
+      while(cursor < last && *cursor == ' ')
+        cursor++;
+      minus = false;
+      if(cursor < last && (*cursor == '-' || *cursor == '+'))
+        minus = *cursor++ == '-';
+      return cursor;
+    }
+  }
+
+  numberResult decodeNumber(const char *first, const char *last, double &value)
+  {
+    bool minus;
+    const char *cursor = skipSpacesAndSign(first, last, minus);
+
+    // The number is gathered as significant digits and a decimal exponent: decimals * 10^exponent.
+    char decimals[maxDecimalDigits];
+    int length = 0, exponent = 0;
+    uint64_t significand = 0; // First 19 significant digits, for the fast path
+    bool anyDigit = false;
+
+    for(; cursor < last && isDigit(*cursor); cursor++)
+    {
+      anyDigit = true;
+      if(length == 0 && *cursor == '0')
+        continue; // Leading zero
+      if(length < maxDecimalDigits)
+      {
+        if(length < 19)
+          significand = significand * 10 + static_cast<unsigned>(*cursor - '0');
+        decimals[length++] = *cursor;
+      }
+      else
+        exponent++; // Dropped integer digit
+    }
+
+    if(cursor < last && *cursor == '.')
+      for(cursor++; cursor < last && isDigit(*cursor); cursor++)
+      {
+        anyDigit = true;
+        if(length == 0 && *cursor == '0')
+        {
+          exponent--; // Leading zero after the decimal point only shifts the exponent
+          continue;
+        }
+        if(length < maxDecimalDigits)
+        {
+          if(length < 19)
+            significand = significand * 10 + static_cast<unsigned>(*cursor - '0');
+          decimals[length++] = *cursor;
+          exponent--;
+        }
+      }
+
+    if(!anyDigit)
+      return { first, numberError::invalid };
+
+    // Exponent part. Like strtod, an 'e' not followed by digits is not part of the number.
+    if(cursor < last && (*cursor == 'e' || *cursor == 'E'))
+    {
+      const char *expCursor = cursor + 1;
+      bool expMinus = false;
+      if(expCursor < last && (*expCursor == '-' || *expCursor == '+'))
+        expMinus = *expCursor++ == '-';
+      if(expCursor < last && isDigit(*expCursor))
+      {
+        int explicitExponent = 0;
+        for(; expCursor < last && isDigit(*expCursor); expCursor++)
+          if(explicitExponent < maxExponentMagnitude)
+            explicitExponent = explicitExponent * 10 + (*expCursor - '0');
+        exponent += expMinus ? -explicitExponent : explicitExponent;
+        cursor = expCursor;
+      }
+    }
+
+    double result;
+    if(length == 0)
+      result = 0.0;
+    else if(length <= 19 && significand <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+      // Both operands are exact, so a single multiplication or division rounds correctly.
+      result = exponent < 0 ? static_cast<double>(significand) / exactPowersOfTen[-exponent] :
+                              static_cast<double>(significand) * exactPowersOfTen[exponent];
+    else
+    {
+      if(exponent < -maxExponentMagnitude || exponent > maxExponentMagnitude)
+        result = exponent < 0 ? 0.0 : std::numeric_limits<double>::infinity();
+      else
+        result = rapidjson::internal::StrtodFullPrecision(static_cast<double>(significand),
+                                                          exponent + (length > 19 ? length - 19 : 0),
+                                                          decimals, length, length, exponent);
+    }
+
+    if(result > std::numeric_limits<double>::max())
+      return { cursor, numberError::outOfRange };
+
+    value = minus ? -result : result;
+    return { cursor, numberError::none };
+  }
+
+  numberResult decodeNumber(const char *first, const char *last, int &value)
+  {
+    bool minus, overflow = false;
+    const char *cursor = skipSpacesAndSign(first, last, minus), *digitsBegin = cursor;
+    long long magnitude = 0;
+
+    for(; cursor < last && isDigit(*cursor); cursor++)
+      if(!overflow && (magnitude = magnitude * 10 + (*cursor - '0')) > static_cast<long long>(INT_MAX) + 1)
+        overflow = true;
+
+    if(cursor == digitsBegin)
+      return { first, numberError::invalid };
+    if(overflow || (!minus && magnitude > INT_MAX))
+      return { cursor, numberError::outOfRange };
+
+    value = static_cast<int>(minus ? -magnitude : magnitude);
+    return { cursor, numberError::none };
+  }
+}
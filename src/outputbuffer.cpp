@@ -0,0 +1,113 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+
+#include "outputbuffer.hpp"
+
+namespace lc2kicad
+{
+  OutputBuffer::OutputBuffer(std::ostream &sink, size_t chunkSize)
+    : sink(sink), buffer(new char[chunkSize]), capacity(chunkSize) { }
+
+  OutputBuffer::~OutputBuffer() { flush(); }
+
+  void OutputBuffer::flush()
+  {
+    if(used)
+      sink.write(buffer.get(), static_cast<std::streamsize>(used));
+    used = 0;
+  }
+
+  OutputBuffer& OutputBuffer::operator<<(long long value)
+  {
+    char digits[24];
+    append(digits, static_cast<size_t>(std::snprintf(digits, sizeof digits, "%lld", value)));
+    return *this;
+  }
+
+  OutputBuffer& OutputBuffer::operator<<(unsigned long long value)
+  {
+    char digits[24];
+    append(digits, static_cast<size_t>(std::snprintf(digits, sizeof digits, "%llu", value)));
+    return *this;
+  }
+
+  /*
+   * Fixed-point formatting: scale by 10^decimalPlaces, round once to an integer, and print the integer with
+   * the decimal point put back in. The result is the same as printf's "%.6f" with the trailing zeros cut.
+   */
+  OutputBuffer& OutputBuffer::operator<<(double value)
+  {
+    static const uint64_t powersOfTen[] = { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+                                            10000000ull, 100000000ull, 1000000000ull };
+    double product = std::fabs(value) * static_cast<double>(powersOfTen[decimalPlaces]),
+           scaled = std::round(product);
+
+    // The product is off by half an ulp at most, which only matters if it lands that close to a rounding tie.
+    // printf rounds those from the exact value. Also catches NaN and infinities.
+    if(!(product < 9007199254740992.0) || std::fabs(product - std::floor(product) - 0.5) <= product * 2.3e-16)
+    {
+      char digits[320]; // "%f" of the largest double
+      int length = std::snprintf(digits, sizeof digits, "%.*f", static_cast<int>(decimalPlaces), value);
+      if(decimalPlaces && length > 0 && std::isfinite(value))
+      {
+        while(digits[length - 1] == '0')
+          length--;
+        if(digits[length - 1] == '.')
+          length--;
+      }
+      char *start = digits;
+      if(length == 2 && digits[0] == '-' && digits[1] == '0') // No "-0" either, like below
+        start++, length--;
+      append(start, static_cast<size_t>(length));
+      return *this;
+    }
+
+    uint64_t units = static_cast<uint64_t>(scaled),
+             integral = units / powersOfTen[decimalPlaces],
+             fraction = units % powersOfTen[decimalPlaces];
+    unsigned int fractionDigits = decimalPlaces;
+    while(fractionDigits && fraction % 10 == 0) // Trailing zeros
+    {
+      fraction /= 10;
+      fractionDigits--;
+    }
+
+    // Written back to front
+    char digits[32];
+    char *cursor = digits + sizeof digits;
+    if(fractionDigits)
+    {
+      for(unsigned int i = 0; i < fractionDigits; i++, fraction /= 10)
+        *--cursor = static_cast<char>('0' + fraction % 10);
+      *--cursor = '.';
+    }
+    do
+      *--cursor = static_cast<char>('0' + integral % 10);
+    while(integral /= 10);
+    if(value < 0 && units) // No "-0"
+      *--cursor = '-';
+
+    append(cursor, static_cast<size_t>(digits + sizeof digits - cursor));
+    return *this;
+  }
+}
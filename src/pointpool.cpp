@@ -0,0 +1,49 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pointpool.hpp"
+
+namespace lc2kicad
+{
+  size_t PointPool::beginRange(coordinates origin, double scale)
+  {
+    if(pendingRuns.empty() || pendingRuns.back().origin.X != origin.X || pendingRuns.back().origin.Y != origin.Y ||
+       pendingRuns.back().scale != scale)
+      pendingRuns.push_back({ X.size(), origin, scale });
+    return X.size();
+  }
+
+  void PointPool::transform()
+  {
+    for(size_t i = 0; i < pendingRuns.size(); i++)
+    {
+      const run &current = pendingRuns[i];
+      size_t last = i + 1 < pendingRuns.size() ? pendingRuns[i + 1].first : X.size();
+      double *x = X.data(), *y = Y.data();
+      const double originX = current.origin.X, originY = current.origin.Y, scale = current.scale;
+
+      for(size_t j = current.first; j < last; j++)
+        x[j] = (x[j] - originX) * scale;
+      for(size_t j = current.first; j < last; j++)
+        y[j] = (y[j] - originY) * scale;
+    }
+    pendingRuns.clear();
+  }
+}
@@ -0,0 +1,123 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <cmath>
+#include <queue>
+#include <vector>
+
+#include "polygonsimplifier.hpp"
+
+namespace lc2kicad
+{
+  namespace
+  {
+    double distance(double x0, double y0, double x1, double y1) { return std::hypot(x1 - x0, y1 - y0); }
+
+    // Distance from point p to the segment from a to b
+    double segmentDistance(double px, double py, double ax, double ay, double bx, double by)
+    {
+      double dx = bx - ax, dy = by - ay, lengthSquared = dx * dx + dy * dy;
+      if(lengthSquared == 0.0)
+        return distance(px, py, ax, ay);
+      double t = ((px - ax) * dx + (py - ay) * dy) / lengthSquared;
+      t = t < 0.0 ? 0.0 : t > 1.0 ? 1.0 : t;
+      return distance(px, py, ax + t * dx, ay + t * dy);
+    }
+
+    // Points strictly between first and last (which is count for the first point again), and the farthest of them
+    struct span
+    {
+      size_t first, last, farthest;
+      double distance;
+      bool operator<(const span &other) const { return distance < other.distance; }
+    };
+  }
+
+  size_t simplifyPolygon(double *x, double *y, size_t count, double tolerance, size_t vertexBudget)
+  {
+    if(!count)
+      return 0;
+
+    // Points left after dropping the ones within reach of the last point left, and closing ones repeating the first
+    std::vector<size_t> survivors;
+    auto dropNearPoints = [&](double reach)
+    {
+      survivors.assign(1, 0);
+      for(size_t i = 1; i < count; i++)
+        if(distance(x[i], y[i], x[survivors.back()], y[survivors.back()]) > reach)
+          survivors.push_back(i);
+      while(survivors.size() > 1 && distance(x[survivors.back()], y[survivors.back()], x[0], y[0]) <= reach)
+        survivors.pop_back();
+    };
+
+    // Outlines smaller than the tolerance would collapse below a polygon; only drop repeated points from those
+    dropNearPoints(tolerance);
+    if(survivors.size() < 3)
+      dropNearPoints(0.0);
+    size_t kept = survivors.size();
+    for(size_t i = 0; i < kept; i++)
+      x[i] = x[survivors[i]], y[i] = y[survivors[i]];
+    if(kept <= 3)
+      return kept;
+
+    // Start from the first point and the one farthest from it, which splits the ring in two
+    size_t opposite = 1;
+    for(size_t i = 2; i < kept; i++)
+      if(distance(x[i], y[i], x[0], y[0]) > distance(x[opposite], y[opposite], x[0], y[0]))
+        opposite = i;
+
+    std::vector<char> keep(kept, 0);
+    std::priority_queue<span> spans;
+    auto addSpan = [&](size_t first, size_t last)
+    {
+      size_t end = last == kept ? 0 : last;
+      span farthest { first, last, first, -1.0 };
+      for(size_t i = first + 1; i < last; i++)
+      {
+        double d = segmentDistance(x[i], y[i], x[first], y[first], x[end], y[end]);
+        if(d > farthest.distance)
+          farthest.farthest = i, farthest.distance = d;
+      }
+      if(farthest.farthest != first)
+        spans.push(farthest);
+    };
+
+    keep[0] = keep[opposite] = 1;
+    size_t keptCount = 2;
+    addSpan(0, opposite);
+    addSpan(opposite, kept);
+    while(!spans.empty() && (!vertexBudget || keptCount < vertexBudget || keptCount < 3))
+    {
+      span top = spans.top();
+      if(top.distance <= tolerance && keptCount >= 3)
+        break;
+      spans.pop();
+      keep[top.farthest] = 1, keptCount++;
+      addSpan(top.first, top.farthest);
+      addSpan(top.farthest, top.last);
+    }
+
+    size_t result = 0;
+    for(size_t i = 0; i < kept; i++)
+      if(keep[i])
+        x[result] = x[i], y[result] = y[i], result++;
+    return result;
+  }
+}
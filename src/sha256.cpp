@@ -0,0 +1,116 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "sha256.hpp"
+
+namespace lc2kicad
+{
+  static const uint32_t sha256RoundConstants[64] =
+  {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+  static inline uint32_t rotateRight(uint32_t value, unsigned int bits) { return (value >> bits) | (value << (32 - bits)); }
+
+  SHA256::SHA256()
+  {
+    static const uint32_t initialState[8] =
+      { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    std::memcpy(state, initialState, sizeof(state));
+  }
+
+  void SHA256::update(const void *data, size_t length)
+  {
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    totalBytes += length;
+
+    if(bufferedBytes)
+    {
+      size_t take = std::min(length, sizeof(buffer) - bufferedBytes);
+      std::memcpy(buffer + bufferedBytes, bytes, take);
+      bufferedBytes += take, bytes += take, length -= take;
+      if(bufferedBytes < sizeof(buffer))
+        return;
+      processBlock(buffer);
+      bufferedBytes = 0;
+    }
+
+    for(; length >= sizeof(buffer); bytes += sizeof(buffer), length -= sizeof(buffer))
+      processBlock(bytes);
+
+    std::memcpy(buffer, bytes, length);
+    bufferedBytes = length;
+  }
+
+  std::string SHA256::hexDigest()
+  {
+    uint64_t totalBits = totalBytes * 8;
+    uint8_t padding[72] = { 0x80 };
+    size_t paddingLength = (bufferedBytes < 56 ? 56 : 120) - bufferedBytes;
+    for(int i = 0; i < 8; i++)
+      padding[paddingLength + i] = static_cast<uint8_t>(totalBits >> (56 - 8 * i));
+    update(padding, paddingLength + 8);
+
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string ret;
+    ret.reserve(64);
+    for(uint32_t word : state)
+      for(int shift = 28; shift >= 0; shift -= 4)
+        ret += hexDigits[(word >> shift) & 0xf];
+    return ret;
+  }
+
+  void SHA256::processBlock(const uint8_t *block)
+  {
+    uint32_t w[64];
+    for(int i = 0; i < 16; i++)
+      w[i] = uint32_t(block[4 * i]) << 24 | uint32_t(block[4 * i + 1]) << 16 | uint32_t(block[4 * i + 2]) << 8 |
+             uint32_t(block[4 * i + 3]);
+    for(int i = 16; i < 64; i++)
+    {
+      uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3),
+               s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+             e = state[4], f = state[5], g = state[6], h = state[7];
+    for(int i = 0; i < 64; i++)
+    {
+      uint32_t t1 = h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25)) + ((e & f) ^ (~e & g)) +
+                    sha256RoundConstants[i] + w[i],
+               t2 = (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g, g = f, f = e, e = d + t1, d = c, c = b, b = a, a = t1 + t2;
+    }
+
+    state[0] += a, state[1] += b, state[2] += c, state[3] += d;
+    state[4] += e, state[5] += f, state[6] += g, state[7] += h;
+  }
+}
@@ -0,0 +1,226 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+
+#include "consts.hpp"
+#include "includes.hpp"
+#include "rapidjson.hpp"
+#include "rapidjson/stringbuffer.h"
+#include "streamreader.hpp"
+
+using std::string;
+using std::vector;
+using rapidjson::SizeType;
+
+namespace lc2kicad
+{
+  /**
+   * Parser state and SAX handler. Tracks where in the document we are, copies head and DRC rules
+   * into the header writer (DRC rules coming after the header is closed into a writer of their own),
+   * and dispatches shape strings.
+   *
+   * depth counts open containers: keys and values of the root object are at depth 1, the entries
+   * of the root "shape" array are at depth 2.
+   */
+  struct EasyEDAStreamReader::streamState
+  {
+    static const size_t readBufferSize = 65536;
+
+    vector<char> readBuffer;
+    rapidjson::FileReadStream stream;
+    rapidjson::Reader reader;
+
+    rapidjson::StringBuffer headerJson, lateJson;
+    rapidjson::Writer<rapidjson::StringBuffer> headerWriter, lateWriter;
+    rapidjson::Writer<rapidjson::StringBuffer> *captureWriter = nullptr; // Where the value being captured goes
+    bool headSeen = false, canvasSeen = false, DRCRulesSeen = false, headerClosed = false;
+
+    unsigned depth = 0;
+    string topKey;
+    bool capturing = false, inShapes = false;
+
+    const shapeConsumer *consumer = nullptr;
+    vector<string> pendingShapes;
+
+    streamState(std::FILE *file)
+      : readBuffer(readBufferSize), stream(file, readBuffer.data(), readBuffer.size()), headerWriter(headerJson),
+        lateWriter(lateJson)
+    {
+      headerWriter.StartObject();
+      lateWriter.StartObject();
+    }
+
+    bool headerReady() const { return headSeen && canvasSeen; }
+
+    bool startContainer(bool isArray)
+    {
+      if(!capturing && depth == 1)
+      {
+        if((!headerClosed && topKey == "head") || (!DRCRulesSeen && topKey == "DRCRULE"))
+        {
+          capturing = true;
+          captureWriter = headerClosed ? &lateWriter : &headerWriter;
+          captureWriter->Key(topKey.c_str(), static_cast<SizeType>(topKey.size()));
+        }
+        else if(isArray && topKey == "shape")
+          inShapes = true;
+      }
+      depth++;
+      if(capturing)
+        return isArray ? captureWriter->StartArray() : captureWriter->StartObject();
+      return true;
+    }
+
+    bool endContainer(bool isArray)
+    {
+      bool ret = true;
+      depth--;
+      if(capturing)
+      {
+        ret = isArray ? captureWriter->EndArray() : captureWriter->EndObject();
+        if(depth == 1)
+        {
+          capturing = false;
+          if(topKey == "head")
+            headSeen = true;
+          else
+            DRCRulesSeen = true;
+        }
+      }
+      if(depth == 1)
+        inShapes = false;
+      return ret;
+    }
+
+    // RapidJSON handler interface
+    bool Null() { return capturing ? captureWriter->Null() : true; }
+    bool Bool(bool b) { return capturing ? captureWriter->Bool(b) : true; }
+    bool Int(int i) { return capturing ? captureWriter->Int(i) : true; }
+    bool Uint(unsigned u) { return capturing ? captureWriter->Uint(u) : true; }
+    bool Int64(int64_t i) { return capturing ? captureWriter->Int64(i) : true; }
+    bool Uint64(uint64_t u) { return capturing ? captureWriter->Uint64(u) : true; }
+    bool Double(double d) { return capturing ? captureWriter->Double(d) : true; }
+    bool RawNumber(const char *str, SizeType length, bool) { return capturing ? captureWriter->RawNumber(str, length) : true; }
+    bool StartObject() { return startContainer(false); }
+    bool EndObject(SizeType) { return endContainer(false); }
+    bool StartArray() { return startContainer(true); }
+    bool EndArray(SizeType) { return endContainer(true); }
+
+    bool Key(const char *str, SizeType length, bool)
+    {
+      if(capturing)
+        return captureWriter->Key(str, length);
+      if(depth == 1)
+        topKey.assign(str, length);
+      return true;
+    }
+
+    bool String(const char *str, SizeType length, bool)
+    {
+      if(capturing)
+        return captureWriter->String(str, length);
+
+      if(depth == 1 && topKey == "canvas" && !headerClosed)
+      {
+        headerWriter.Key("canvas");
+        headerWriter.String(str, length);
+        canvasSeen = true;
+      }
+      else if(depth == 2 && inShapes)
+      {
+        if(consumer)
+          (*consumer)(fieldView(str, length));
+        else
+          pendingShapes.emplace_back(str, length);
+      }
+      return true;
+    }
+  };
+
+  EasyEDAStreamReader::EasyEDAStreamReader(std::FILE *file) : state(new streamState(file))
+  {
+    state->reader.IterativeParseInit();
+  }
+
+  EasyEDAStreamReader::~EasyEDAStreamReader() { }
+
+  void EasyEDAStreamReader::readUntil(const std::function<bool()> &stopCondition)
+  {
+    rapidjson::Reader &reader = state->reader;
+
+    while(!reader.IterativeParseComplete() && !stopCondition())
+      if(!reader.IterativeParseNext<rapidjson::kParseDefaultFlags>(state->stream, *state))
+        break;
+
+    assertThrow(!reader.HasParseError(),
+                string("RapidJSON reported error when parsing the file. Error code: ") +
+                rapidjsonErrorMsg[reader.GetParseErrorCode()] + ", offset " +
+                std::to_string(reader.GetErrorOffset()) + ".\n");
+  }
+
+  bool EasyEDAStreamReader::readHeader()
+  {
+    readUntil([this]() { return state->headerReady(); });
+
+    // Close the header object with an empty shape array, so it's structured like a real document
+    rapidjson::Writer<rapidjson::StringBuffer> &writer = state->headerWriter;
+    writer.Key("shape");
+    writer.StartArray();
+    writer.EndArray();
+    writer.EndObject();
+    state->headerClosed = true;
+
+    header = std::make_shared<rapidjson::Document>();
+    header->Parse(state->headerJson.GetString(), state->headerJson.GetSize());
+    state->headerJson.Clear();
+    state->headerJson.ShrinkToFit();
+
+    return state->headerReady();
+  }
+
+  void EasyEDAStreamReader::readShapes(const shapeConsumer &consumer)
+  {
+    for(auto &i : state->pendingShapes)
+      consumer(fieldView(i));
+    vector<string>().swap(state->pendingShapes);
+
+    state->consumer = &consumer;
+    try
+    {
+      readUntil([]() { return false; });
+    }
+    catch(...)
+    {
+      state->consumer = nullptr;
+      throw;
+    }
+    state->consumer = nullptr;
+
+    // DRC rules written after the shapes (EasyEDA puts them last) join the header document now
+    state->lateWriter.EndObject();
+    rapidjson::Document late;
+    late.Parse(state->lateJson.GetString(), state->lateJson.GetSize());
+    if(late.IsObject())
+      for(auto &i : late.GetObject())
+        header->AddMember(rapidjson::Value(i.name, header->GetAllocator()),
+                          rapidjson::Value(i.value, header->GetAllocator()), header->GetAllocator());
+  }
+}
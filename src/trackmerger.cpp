@@ -0,0 +1,384 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "includes.hpp"
+#include "consts.hpp"
+#include "edaclasses.hpp"
+#include "trackmerger.hpp"
+
+using std::vector;
+
+namespace lc2kicad
+{
+  namespace
+  {
+    const double pointResolution = 1e-6; // Of the output, in mm. Points closer than this are the same point
+    const double cellSize = 2.54; // Edge of the grid cells things touching a point are looked up in, in mm
+    const size_t noTrack = SIZE_MAX;
+
+    struct pointKey
+    {
+      int64_t X, Y;
+      bool operator==(const pointKey &other) const { return X == other.X && Y == other.Y; }
+    };
+
+    struct pointKeyHash
+    {
+      size_t operator()(const pointKey &key) const
+        { return std::hash<int64_t>()(key.X) * 1000003 ^ std::hash<int64_t>()(key.Y); }
+    };
+
+    pointKey keyOf(const coordinates &point, double resolution = pointResolution)
+      { return { std::llround(std::floor(point.X / resolution)), std::llround(std::floor(point.Y / resolution)) }; }
+    bool samePoint(const coordinates &a, const coordinates &b)
+      { return std::llround(a.X / pointResolution) == std::llround(b.X / pointResolution) &&
+               std::llround(a.Y / pointResolution) == std::llround(b.Y / pointResolution); }
+
+    double distance(const coordinates &a, const coordinates &b) { return std::hypot(b.X - a.X, b.Y - a.Y); }
+
+    double segmentDistance(const coordinates &point, const coordinates &a, const coordinates &b)
+    {
+      double dx = b.X - a.X, dy = b.Y - a.Y, lengthSquared = dx * dx + dy * dy;
+      if(lengthSquared == 0.0)
+        return distance(point, a);
+      double t = ((point.X - a.X) * dx + (point.Y - a.Y) * dy) / lengthSquared;
+      t = t < 0.0 ? 0.0 : t > 1.0 ? 1.0 : t;
+      return distance(point, coordinates(a.X + t * dx, a.Y + t * dy));
+    }
+
+    bool isCopperLayer(int layer) { return layer >= F_Cu && layer <= B_Cu; }
+
+    /**
+     * Copper a track point can touch: segments from a to b (discs where a is b) radius wide on each side,
+     * or rings of radius around a, ringWidth wide. Layer -1 is on every copper layer.
+     */
+    struct body
+    {
+      coordinates a, b;
+      double radius, ringWidth;
+      int layer;
+      size_t track; // The board level track the segment is of, or noTrack
+
+      bool touches(const coordinates &point) const
+      {
+        if(ringWidth > 0)
+          return std::abs(distance(point, a) - radius) <= ringWidth / 2 + pointResolution;
+        return segmentDistance(point, a, b) <= radius + pointResolution;
+      }
+    };
+
+    struct box
+    {
+      double minX, minY, maxX, maxY;
+      int layer;
+    };
+
+    // What's on the copper of the board, looked up by point
+    class copperMap
+    {
+      public:
+        void addBody(const body &item)
+        {
+          double reach = item.ringWidth > 0 ? item.radius + item.ringWidth / 2 : item.radius;
+          pointKey first = keyOf(coordinates(std::min(item.a.X, item.b.X) - reach, std::min(item.a.Y, item.b.Y) - reach),
+                                 cellSize),
+                   last = keyOf(coordinates(std::max(item.a.X, item.b.X) + reach, std::max(item.a.Y, item.b.Y) + reach),
+                                cellSize);
+          for(int64_t x = first.X; x <= last.X; x++)
+            for(int64_t y = first.Y; y <= last.Y; y++)
+              cells[{ x, y }].push_back(bodies.size());
+          bodies.push_back(item);
+        }
+
+        void addBox(const box &item) { boxes.push_back(item); }
+
+        // Whether anything on layer touches point, leaving out the segments of tracks isOwn returns true for
+        template<typename ownTest> bool touched(const coordinates &point, int layer, ownTest isOwn) const
+        {
+          for(auto &i : boxes)
+            if(i.layer == layer && point.X >= i.minX - pointResolution && point.X <= i.maxX + pointResolution &&
+               point.Y >= i.minY - pointResolution && point.Y <= i.maxY + pointResolution)
+              return true;
+
+          auto cell = cells.find(keyOf(point, cellSize));
+          if(cell == cells.end())
+            return false;
+          for(auto i : cell->second)
+          {
+            const body &item = bodies[i];
+            if((item.layer == -1 || item.layer == layer) && !(item.track != noTrack && isOwn(item.track)) &&
+               item.touches(point))
+              return true;
+          }
+          return false;
+        }
+
+      private:
+        vector<body> bodies;
+        vector<box> boxes;
+        std::unordered_map<pointKey, vector<size_t>, pointKeyHash> cells;
+    };
+
+    struct track
+    {
+      PCB_GraphicalTrack *element;
+      size_t position; // In the document's containedElements
+      bool copper, removed;
+      PCBNet net;
+      vector<coordinates> points;
+    };
+
+    // The track linked to one end of another, and which of its own ends is the linked one
+    struct link
+    {
+      size_t track = noTrack;
+      bool atStart;
+    };
+
+    // Copper of a footprint, or of the board when offset is zero, other than the board level tracks
+    void addCopper(copperMap &copper, const EDAElement *element, const coordinates &offset)
+    {
+      switch(element->kind)
+      {
+        case PCBModule:
+        {
+          auto module = static_cast<const PCB_Module*>(element);
+          for(auto i : module->containedElements)
+            addCopper(copper, i, coordinates(offset.X + module->moduleCoords.X, offset.Y + module->moduleCoords.Y));
+          break;
+        }
+        case PCBPad:
+        {
+          auto pad = static_cast<const PCB_Pad*>(element);
+          double radius = std::hypot(pad->padSize.X, pad->padSize.Y) / 2;
+          for(auto &i : pad->shapePolygonPoints)
+            radius = std::max(radius, std::hypot(i.X, i.Y));
+          coordinates center(offset.X + pad->padCoordinates.X, offset.Y + pad->padCoordinates.Y);
+          copper.addBody({ center, center, radius, 0, -1, noTrack });
+          break;
+        }
+        case PCBVia:
+        {
+          auto via = static_cast<const PCB_Via*>(element);
+          coordinates center(offset.X + via->holeCoordinates.X, offset.Y + via->holeCoordinates.Y);
+          copper.addBody({ center, center, via->viaDiameter / 2, 0, -1, noTrack });
+          break;
+        }
+        case PCBCopperTrack: // Only ones in footprints get here
+        {
+          auto copperTrack = static_cast<const PCB_CopperTrack*>(element);
+          for(size_t i = 0; i + 1 < copperTrack->trackPoints.size(); i++)
+          {
+            coordinates a = copperTrack->trackPoints[i], b = copperTrack->trackPoints[i + 1];
+            copper.addBody({ coordinates(offset.X + a.X, offset.Y + a.Y), coordinates(offset.X + b.X, offset.Y + b.Y),
+                             copperTrack->width / 2, 0, copperTrack->layerKiCad, noTrack });
+          }
+          break;
+        }
+        case PCBCopperArc:
+        {
+          auto arc = static_cast<const PCB_CopperArc*>(element);
+          coordinates center(offset.X + arc->center.X, offset.Y + arc->center.Y);
+          copper.addBody({ center, center, distance(arc->center, arc->endPoint), arc->width, arc->layerKiCad, noTrack });
+          break;
+        }
+        case PCBCopperCircle:
+        {
+          auto circle = static_cast<const PCB_CopperCircle*>(element);
+          coordinates center(offset.X + circle->center.X, offset.Y + circle->center.Y);
+          copper.addBody({ center, center, circle->radius, circle->width, circle->layerKiCad, noTrack });
+          break;
+        }
+        case PCBFloodFill:
+        case PCBCopperSolidRegion:
+        case PCBSolidRegion:
+        {
+          auto region = static_cast<const PCB_GraphicalSolidRegion*>(element);
+          int layer = element->kind == PCBSolidRegion ? region->layerKiCad
+                                                      : static_cast<const PCB_CopperSolidRegion*>(element)->layerKiCad;
+          if(!isCopperLayer(layer) || region->fillAreaPolygonPoints.empty())
+            break;
+          box bounds { INFINITY, INFINITY, -INFINITY, -INFINITY, layer };
+          for(auto i : region->fillAreaPolygonPoints)
+            bounds.minX = std::min(bounds.minX, offset.X + i.X), bounds.maxX = std::max(bounds.maxX, offset.X + i.X),
+            bounds.minY = std::min(bounds.minY, offset.Y + i.Y), bounds.maxY = std::max(bounds.maxY, offset.Y + i.Y);
+          copper.addBox(bounds);
+          break;
+        }
+        case PCBRect:
+        {
+          auto rect = static_cast<const PCB_Rect*>(element);
+          if(isCopperLayer(rect->layerKiCad))
+          {
+            double left = offset.X + rect->topLeftPos.X, top = offset.Y + rect->topLeftPos.Y;
+            copper.addBox({ left, top, left + rect->size.X, top + rect->size.Y, rect->layerKiCad });
+          }
+          break;
+        }
+        default:;
+      }
+    }
+  }
+
+  trackMergeResult mergePCBTracks(PCBDocument &document)
+  {
+    trackMergeResult result { 0, 0 };
+    vector<track> tracks;
+    copperMap copper;
+
+    for(size_t i = 0; i < document.containedElements.size(); i++)
+    {
+      EDAElement *element = document.containedElements[i];
+      if(element->kind != PCBGraphicalTrack && element->kind != PCBCopperTrack)
+      {
+        addCopper(copper, element, coordinates(0, 0));
+        continue;
+      }
+
+      auto trackElement = static_cast<PCB_GraphicalTrack*>(element);
+      bool isCopper = element->kind == PCBCopperTrack;
+      tracks.push_back({ trackElement, i, isCopper, false, isCopper ? static_cast<PCB_CopperTrack*>(element)->net : 0, {} });
+      vector<coordinates> &points = tracks.back().points;
+      for(auto j : trackElement->trackPoints)
+        if(points.empty() || !samePoint(points.back(), j))
+          points.push_back(j);
+      if(trackElement->trackPoints.size())
+        result.segmentsBefore += trackElement->trackPoints.size() - 1;
+      if(points.size() < 2) // Zero length
+        tracks.back().removed = true;
+    }
+
+    for(size_t i = 0; i < tracks.size(); i++)
+      if(tracks[i].copper && !tracks[i].removed)
+        for(size_t j = 0; j + 1 < tracks[i].points.size(); j++)
+          copper.addBody({ tracks[i].points[j], tracks[i].points[j + 1], tracks[i].element->width / 2, 0,
+                           tracks[i].element->layerKiCad, i });
+
+    // Tracks that may be joined, in document order
+    std::map<std::tuple<bool, PCBNet, int, double>, vector<size_t>> groups;
+    for(size_t i = 0; i < tracks.size(); i++)
+      if(!tracks[i].removed)
+        groups[std::make_tuple(tracks[i].copper, tracks[i].net, static_cast<int>(tracks[i].element->layerKiCad),
+                               tracks[i].element->width)].push_back(i);
+
+    vector<link> startLinks(tracks.size()), endLinks(tracks.size());
+    vector<size_t> chainOf(tracks.size(), noTrack);
+    PointPool &pool = document.pointPool;
+
+    for(auto &group : groups)
+    {
+      std::unordered_map<pointKey, vector<link>, pointKeyHash> ends;
+      for(auto i : group.second)
+      {
+        ends[keyOf(tracks[i].points.front())].push_back({ i, true });
+        ends[keyOf(tracks[i].points.back())].push_back({ i, false });
+      }
+
+      // Join where two ends of different tracks meet, and no other track of the group or copper is there
+      for(auto &i : ends)
+      {
+        if(i.second.size() != 2 || i.second[0].track == i.second[1].track)
+          continue;
+        const link &a = i.second[0], &b = i.second[1];
+        const track &first = tracks[a.track];
+        coordinates point = a.atStart ? first.points.front() : first.points.back();
+        if(first.copper && copper.touched(point, first.element->layerKiCad,
+                                          [&](size_t j) { return j == a.track || j == b.track; }))
+          continue;
+        (a.atStart ? startLinks : endLinks)[a.track] = b;
+        (b.atStart ? startLinks : endLinks)[b.track] = a;
+      }
+
+      for(auto head : group.second)
+      {
+        if(chainOf[head] != noTrack)
+          continue;
+        chainOf[head] = head;
+
+        // Walk away from each end of the first track of the chain in document order
+        vector<coordinates> before, after = tracks[head].points;
+        for(bool forward : { true, false })
+        {
+          vector<coordinates> &line = forward ? after : before;
+          link next = forward ? endLinks[head] : startLinks[head];
+          while(next.track != noTrack && chainOf[next.track] == noTrack)
+          {
+            track &current = tracks[next.track];
+            chainOf[next.track] = head;
+            current.removed = true;
+            if(next.atStart)
+              line.insert(line.end(), current.points.begin() + 1, current.points.end());
+            else
+              line.insert(line.end(), current.points.rbegin() + 1, current.points.rend());
+            next = next.atStart ? endLinks[next.track] : startLinks[next.track];
+          }
+        }
+        vector<coordinates> line(before.rbegin(), before.rend());
+        line.insert(line.end(), after.begin(), after.end());
+
+        // Drop points on the straight line between the ones kept around them, unless other copper touches them
+        track &chain = tracks[head];
+        vector<coordinates> kept { line.front() };
+        size_t lastKept = 0;
+        for(size_t i = 1; i + 1 < line.size(); i++)
+        {
+          bool straight = true;
+          for(size_t j = lastKept + 1; j <= i && straight; j++)
+            straight = segmentDistance(line[j], line[lastKept], line[i + 1]) <= pointResolution;
+          if(straight && chain.copper && copper.touched(line[i], chain.element->layerKiCad,
+                                                         [&](size_t j) { return chainOf[j] == head; }))
+            straight = false;
+          if(!straight)
+            kept.push_back(line[i]), lastKept = i;
+        }
+        kept.push_back(line.back());
+
+        result.segmentsAfter += kept.size() - 1;
+        if(kept.size() != chain.element->trackPoints.size() || line.size() != chain.points.size())
+        {
+          size_t firstPoint = pool.beginRange(coordinates(0, 0), 1.0);
+          for(auto &i : kept)
+            pool.append(i);
+          chain.element->trackPoints = pool.endRange(firstPoint);
+        }
+      }
+    }
+    pool.transform(); // Points above are already in place; this only closes the run they're in
+
+    vector<char> removed(document.containedElements.size(), 0);
+    for(auto &i : tracks)
+      removed[i.position] = i.removed;
+    size_t kept = 0;
+    for(size_t i = 0; i < document.containedElements.size(); i++)
+      if(!removed[i])
+        document.containedElements[kept++] = document.containedElements[i];
+    document.containedElements.resize(kept);
+
+    return result;
+  }
+}
@@ -0,0 +1,109 @@
+/*
+    Copyright (c) 2020 RigoLigoRLC.
+
+    This file is part of LC2KiCad.
+
+    LC2KiCad is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as
+    published by the Free Software Foundation, version 2, or version 3
+    of the License.
+
+    LC2KiCad is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LC2KiCad. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Checks OutputBuffer's number formatting against printf's "%.*f" with the trailing zeros cut, and that
+ * nothing rounding to zero comes out as "-0". Values are picked to land on or next to rounding ties, which
+ * take the snprintf fallback. Returns non-zero and names the values that fail.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include "outputbuffer.hpp"
+
+using namespace lc2kicad;
+
+namespace
+{
+  int failures = 0;
+
+  std::string format(double value, unsigned int places)
+  {
+    std::ostringstream sink;
+    {
+      OutputBuffer output(sink);
+      output.setDecimalPlaces(places);
+      output << value;
+    }
+    return sink.str();
+  }
+
+  std::string reference(double value, unsigned int places)
+  {
+    char digits[320];
+    int length = std::snprintf(digits, sizeof digits, "%.*f", static_cast<int>(places), value);
+    std::string result(digits, static_cast<size_t>(length));
+    if(places)
+    {
+      while(result.back() == '0')
+        result.pop_back();
+      if(result.back() == '.')
+        result.pop_back();
+    }
+    return result == "-0" ? "0" : result;
+  }
+
+  void check(double value, unsigned int places, const char *expected = nullptr)
+  {
+    std::string got = format(value, places), want = expected ? expected : reference(value, places);
+    if(got != want)
+    {
+      std::printf("FAIL: %.17g at %u places gave [%s], expected [%s]\n", value, places, got.c_str(), want.c_str());
+      failures++;
+    }
+  }
+}
+
+int main()
+{
+  // Ties at the last place, which round by the exact binary value
+  check(-5e-7, 6, "0");
+  check(5e-7, 6);
+  check(-4e-7, 6, "0");
+  check(-2.5e-7, 6, "0");
+  check(-5e-10, 9); // Just past the tie in binary, so -0.000000001
+  check(-0.5, 0, "0");
+  check(-0.05, 1);
+  check(-1.5e-6, 6);
+  check(2.5e-6, 6);
+  check(-0.0000015, 6);
+  check(1.0000005, 6);
+  check(-1.0000005, 6);
+  check(0.1234565, 6);
+  check(-2.54, 6, "-2.54");
+  check(-0.0, 6, "0");
+
+  // Next to ties, and ordinary values, at every precision
+  for(unsigned int places = 0; places <= OutputBuffer::maxDecimalPlaces; places++)
+    for(int i = -2000; i <= 2000; i++)
+    {
+      double tie = (i + 0.5) / 1e6;
+      check(tie, places);
+      check(std::nextafter(tie, 0.0), places);
+      check(std::nextafter(tie, tie * 2), places);
+      check(i * 0.254, places);
+    }
+
+  if(!failures)
+    std::puts("All OutputBuffer formatting checks passed.");
+  return failures ? 1 : 0;
+}